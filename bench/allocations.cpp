@@ -0,0 +1,136 @@
+#include "tiny_rx.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int kEvents = 100000;
+
+struct Result {
+    std::string name;
+    int events = 0;
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+    double ns = 0;
+};
+
+// Runs `emit` for every event, counting allocations made on this thread
+// (work done by executors is measured where they are dispatched from this thread)
+Result measure(const std::string& name, const std::function<void(int)>& emit) {
+    // Warm up: lazily created state and grown containers are not counted
+    for (int i = 0; i < 100; ++i)
+        emit(i);
+
+    Result res{ name, kEvents };
+    tiny_rx::alloc::AllocationMeter meter;
+    const auto started = std::chrono::steady_clock::now();
+    for (int i = 0; i < kEvents; ++i)
+        emit(i);
+    const auto elapsed = std::chrono::steady_clock::now() - started;
+    res.allocations = meter.allocations();
+    res.bytes = meter.bytes();
+    res.ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    return res;
+}
+
+std::string to_json(const Result& res) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3)
+        << "{\"benchmark\":\"" << res.name << "\""
+        << ",\"events\":" << res.events
+        << ",\"allocations_per_event\":" << static_cast<double>(res.allocations) / res.events
+        << ",\"bytes_per_event\":" << static_cast<double>(res.bytes) / res.events
+        << ",\"ns_per_event\":" << res.ns / res.events << "}";
+    return out.str();
+}
+
+Result sync_map_filter() {
+    tiny_rx::Observable<int> observable;
+    int64_t sum = 0;
+    auto subscription = observable.map([](int v) {
+        return v * 2;
+    }).filter([](int v) {
+        return v % 3 != 0;
+    }).subscribe([&sum](int v) {
+        sum += v;
+    });
+    return measure("sync_map_filter", [&observable](int v) { observable.next(v); });
+}
+
+Result sync_string() {
+    tiny_rx::Observable<std::string> observable;
+    size_t total = 0;
+    auto subscription = observable.subscribe([&total](const std::string& s) {
+        total += s.size();
+    });
+    const std::string value(64, 'x');
+    return measure("sync_string", [&observable, &value](int) { observable.next(value); });
+}
+
+Result compact_observable() {
+    tiny_rx::CompactObservable<int> observable;
+    int64_t sum = 0;
+    auto subscription = observable.subscribe([&sum](int v) {
+        sum += v;
+    });
+    return measure("compact_observable", [&observable](int v) { observable.next(v); });
+}
+
+Result run_loop() {
+    tiny_rx::Observable<int> observable;
+    auto executor = std::make_shared<tiny_rx::RunLoopExecutor>();
+    int64_t sum = 0;
+    auto subscription = observable.subscribe_on(executor).subscribe([&sum](int v) {
+        sum += v;
+    });
+    return measure("run_loop", [&observable, &executor](int v) {
+        observable.next(v);
+        executor->dispatch();
+    });
+}
+
+Result broadcast() {
+    tiny_rx::BroadcastObservable<int> observable(tiny_rx::BroadcastParams{ 1024, 1, tiny_rx::BroadcastWaitStrategy::Yield });
+    std::atomic<int64_t> sum{ 0 };
+    auto subscription = observable.subscribe([&sum](int v) {
+        sum.fetch_add(v, std::memory_order_relaxed);
+    });
+    return measure("broadcast_producer", [&observable](int v) { observable.next(v); });
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (!tiny_rx::alloc::hooks_installed()) {
+        std::cerr << "Allocation hooks are not linked\n";
+        return 1;
+    }
+
+    const std::vector<Result> results{
+        sync_map_filter(),
+        sync_string(),
+        compact_observable(),
+        run_loop(),
+        broadcast()
+    };
+
+    std::ofstream file;
+    if (argc > 1)
+        file.open(argv[1], std::ios::app);
+    for (const auto& res : results) {
+        const auto line = to_json(res);
+        std::cout << line << "\n";
+        if (file.is_open())
+            file << line << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,156 @@
+// Replacement of the global operator new / delete counting allocations for
+// allocation_tracker.h. Built as the tiny_rx_allocation_hooks object library and
+// linked only into executables that opt in (tests, benchmarks, debug builds)
+#include "allocation_tracker.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+void* allocate(size_t size) {
+    tiny_rx::alloc::detail::on_allocation(size);
+    if (size == 0)
+        size = 1;
+    while (true) {
+        if (void* ptr = std::malloc(size))
+            return ptr;
+        auto handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* allocate_aligned(size_t size, std::align_val_t alignment) {
+    tiny_rx::alloc::detail::on_allocation(size);
+    if (size == 0)
+        size = 1;
+    const auto align = static_cast<size_t>(alignment);
+    while (true) {
+#ifdef _WIN32
+        if (void* ptr = _aligned_malloc(size, align))
+            return ptr;
+#else
+        void* ptr = nullptr;
+        if (posix_memalign(&ptr, align < sizeof(void*) ? sizeof(void*) : align, size) == 0)
+            return ptr;
+#endif
+        auto handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+void deallocate_aligned(void* ptr) noexcept {
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+struct Installer {
+    Installer() {
+        tiny_rx::alloc::detail::set_hooks_installed();
+    }
+} installer;
+
+} // namespace
+
+void* operator new(size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](size_t size) {
+    return allocate(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    return allocate_aligned(size, alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return allocate_aligned(size, alignment);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return allocate_aligned(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return allocate_aligned(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    deallocate_aligned(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    deallocate_aligned(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    deallocate_aligned(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept {
+    deallocate_aligned(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    deallocate_aligned(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    deallocate_aligned(ptr);
+}
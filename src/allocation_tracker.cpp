@@ -0,0 +1,53 @@
+#include "allocation_tracker.h"
+#include "log.h"
+
+#include <atomic>
+
+namespace tiny_rx::alloc {
+
+namespace {
+
+std::atomic<bool> installed{ false };
+
+void log_violation(const char* hot_path, size_t size) {
+    log(utils::LogSeverity::Error, "Allocation on hot path: ", hot_path, size);
+}
+
+std::atomic<ViolationHandler> violation_handler{ &log_violation };
+
+} // namespace
+
+namespace detail {
+
+void on_allocation(size_t size) noexcept {
+    auto& counters = thread_counters;
+    ++counters.allocations;
+    counters.bytes += size;
+
+    if (hot_path == nullptr)
+        return;
+    // Suspend the hot path while reporting, the handler may allocate
+    const char* name = hot_path;
+    hot_path = nullptr;
+    try {
+        violation_handler.load(std::memory_order_relaxed)(name, size);
+    } catch (...) {
+    }
+    hot_path = name;
+}
+
+void set_hooks_installed() noexcept {
+    installed.store(true);
+}
+
+} // namespace detail
+
+bool hooks_installed() {
+    return installed.load(std::memory_order_relaxed);
+}
+
+void set_violation_handler(ViolationHandler handler) {
+    violation_handler.store(handler ? handler : &log_violation);
+}
+
+} // namespace tiny_rx::alloc
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tiny_rx::alloc {
+
+// Heap allocation accounting. The counters are fed by the replacement of the global
+// operator new from allocation_hooks.cpp, which is opt-in: link the object library
+//     add_executable(app main.cpp $<TARGET_OBJECTS:tiny_rx_allocation_hooks>)
+// Without it hooks_installed() is false and all counters stay zero.
+// Only operator new is counted, malloc() calls made directly (or by C libraries) are not
+
+struct AllocationCounters {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+};
+
+// Called when a hot path allocates, with the name given to HotPathGuard and the size.
+// Called with the hot path suspended, so it may allocate itself
+using ViolationHandler = void (*)(const char* hot_path, size_t size);
+
+namespace detail {
+// Plain thread_local values (no dynamic initialization), safe to use from operator new
+inline thread_local AllocationCounters thread_counters;
+inline thread_local const char* hot_path = nullptr;
+
+void on_allocation(size_t size) noexcept;
+void set_hooks_installed() noexcept;
+} // namespace detail
+
+[[nodiscard]] bool hooks_installed();
+
+// Allocations made by operator new on this thread so far
+inline AllocationCounters thread_allocations() {
+    return detail::thread_counters;
+}
+
+// nullptr restores the default handler, which logs an error
+void set_violation_handler(ViolationHandler handler);
+
+// Marks a hot path on this thread: every allocation made while the object exists is
+// reported to the violation handler. Guards nest, the innermost name is reported.
+// Debug aid: costs a thread_local store when constructed, nothing when hooks
+// are not installed
+class HotPathGuard {
+public:
+    explicit HotPathGuard(const char* name)
+        : previous_{ detail::hot_path } {
+        detail::hot_path = name;
+    }
+
+    ~HotPathGuard() {
+        detail::hot_path = previous_;
+    }
+
+    HotPathGuard(const HotPathGuard&) = delete;
+    HotPathGuard(HotPathGuard&&) = delete;
+    HotPathGuard& operator=(const HotPathGuard&) = delete;
+    HotPathGuard& operator=(HotPathGuard&&) = delete;
+
+private:
+    const char* previous_;
+};
+
+// Allocations made on this thread since construction (or the last reset()), e.g.
+//     AllocationMeter meter;
+//     for (int i = 0; i < n; ++i)
+//         source.next(i);
+//     const double per_event = static_cast<double>(meter.allocations()) / n;
+class AllocationMeter {
+public:
+    AllocationMeter()
+        : start_{ thread_allocations() } {
+    }
+
+    void reset() {
+        start_ = thread_allocations();
+    }
+
+    [[nodiscard]] uint64_t allocations() const {
+        return thread_allocations().allocations - start_.allocations;
+    }
+
+    [[nodiscard]] uint64_t bytes() const {
+        return thread_allocations().bytes - start_.bytes;
+    }
+
+private:
+    AllocationCounters start_;
+};
+
+} // namespace tiny_rx::alloc
@@ -0,0 +1,229 @@
+#include "async_file_writer.h"
+
+#include "log.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace tiny_rx {
+
+namespace {
+
+constexpr size_t kBlockAlignment = 4096;
+
+int open_file(const std::string& path) {
+#ifdef _WIN32
+    return _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    return open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+}
+
+bool write_all(int fd, const char* data, size_t size) {
+    while (size != 0) {
+#ifdef _WIN32
+        const auto written = _write(fd, data, static_cast<unsigned>(std::min<size_t>(size, 1u << 30)));
+#else
+        const auto written = ::write(fd, data, size);
+#endif
+        // Interrupted by a signal before anything was written
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return false;
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+} // namespace
+
+void AsyncFileWriter::AlignedDeleter::operator()(char* p) const {
+    ::operator delete[](p, std::align_val_t{ kBlockAlignment });
+}
+
+AsyncFileWriter::AsyncFileWriter(const std::string& path, size_t buffer_size)
+    : AsyncFileWriter(path, AsyncFileWriterParams{ buffer_size }) {
+}
+
+AsyncFileWriter::AsyncFileWriter(const std::string& path, AsyncFileWriterParams params)
+    : params_{ params } {
+    if (params_.block_size == 0 || params_.max_queued_blocks == 0)
+        throw std::invalid_argument("AsyncFileWriter: block size and queue size must be positive");
+
+    fd_ = open_file(path);
+    if (fd_ < 0)
+        throw std::runtime_error("Unable to open file " + path);
+
+    active_ = acquire_block();
+    last_sync_ = std::chrono::steady_clock::now();
+    thread_ = std::thread([this]() { run(); });
+}
+
+AsyncFileWriter::~AsyncFileWriter() {
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_thread_ = true;
+    }
+    cond_var_.notify_all();
+    thread_.join();
+    if (unsynced_bytes_ != 0 && (params_.sync_every_bytes != 0 || params_.sync_interval.count() != 0))
+        sync_file();
+#ifdef _WIN32
+    _close(fd_);
+#else
+    close(fd_);
+#endif
+}
+
+void AsyncFileWriter::write(const void* data, size_t size) {
+    const auto* bytes = static_cast<const char*>(data);
+    auto lock = std::unique_lock<std::mutex>(mutex_);
+    while (size != 0) {
+        const auto chunk = std::min(size, params_.block_size - active_.size);
+        std::memcpy(active_.data.get() + active_.size, bytes, chunk);
+        active_.size += chunk;
+        bytes += chunk;
+        size -= chunk;
+
+        if (active_.size == params_.block_size)
+            submit(lock);
+    }
+}
+
+void AsyncFileWriter::flush() {
+    auto lock = std::unique_lock<std::mutex>(mutex_);
+    if (active_.size != 0)
+        submit(lock);
+    wait_written(lock);
+}
+
+void AsyncFileWriter::sync() {
+    auto lock = std::unique_lock<std::mutex>(mutex_);
+    if (active_.size != 0)
+        submit(lock);
+    wait_written(lock);
+    sync_file();
+}
+
+const AsyncFileWriterStats& AsyncFileWriter::stats() const {
+    return stats_;
+}
+
+AsyncFileWriter::Block AsyncFileWriter::acquire_block() {
+    if (!free_blocks_.empty()) {
+        auto block = std::move(free_blocks_.back());
+        free_blocks_.pop_back();
+        return block;
+    }
+    Block block;
+    block.data.reset(static_cast<char*>(::operator new[](params_.block_size, std::align_val_t{ kBlockAlignment })));
+    return block;
+}
+
+void AsyncFileWriter::submit(std::unique_lock<std::mutex>& lock) {
+    if (queue_.size() >= params_.max_queued_blocks) {
+        ++stats_.producer_waits;
+        cond_var_.wait(lock, [this]() { return queue_.size() < params_.max_queued_blocks; });
+    }
+    enqueue_active();
+}
+
+void AsyncFileWriter::enqueue_active() {
+    queue_.push_back(std::move(active_));
+    stats_.queue_depth = queue_.size();
+    stats_.max_queue_depth = std::max(stats_.max_queue_depth.load(), queue_.size());
+    active_ = acquire_block();
+    cond_var_.notify_all();
+}
+
+void AsyncFileWriter::wait_written(std::unique_lock<std::mutex>& lock) {
+    cond_var_.wait(lock, [this]() { return queue_.empty() && !writing_; });
+}
+
+void AsyncFileWriter::write_block(const Block& block) {
+    const auto start = std::chrono::steady_clock::now();
+    if (!write_all(fd_, block.data.get(), block.size))
+        log(utils::LogSeverity::Error, "AsyncFileWriter: write failed");
+    const auto latency = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+
+    stats_.bytes_written += block.size;
+    ++stats_.blocks_written;
+    stats_.last_write_latency_ns = latency;
+    stats_.total_write_latency_ns += latency;
+    stats_.max_write_latency_ns = std::max(stats_.max_write_latency_ns.load(), latency);
+}
+
+void AsyncFileWriter::sync_file() {
+#ifdef _WIN32
+    _commit(fd_);
+#else
+    fsync(fd_);
+#endif
+    ++stats_.syncs;
+    unsynced_bytes_ = 0;
+    last_sync_ = std::chrono::steady_clock::now();
+}
+
+void AsyncFileWriter::run() {
+    const bool timed = params_.sync_interval.count() != 0;
+    while (true) {
+        auto lock = std::unique_lock<std::mutex>(mutex_);
+        auto ready = [this]() { return !queue_.empty() || stop_thread_; };
+        if (timed) {
+            if (!cond_var_.wait_until(lock, last_sync_ + params_.sync_interval, ready)) {
+                // Group commit by time: take the partially filled block as well. This thread
+                // can't wait for room in the queue it drains, the block is left for later then
+                if (active_.size != 0 && queue_.size() < params_.max_queued_blocks)
+                    enqueue_active();
+                if (queue_.empty()) {
+                    if (unsynced_bytes_ != 0)
+                        sync_file();
+                    else
+                        last_sync_ = std::chrono::steady_clock::now();
+                    continue;
+                }
+            }
+        } else {
+            cond_var_.wait(lock, ready);
+        }
+        if (queue_.empty())
+            break;
+
+        auto block = std::move(queue_.front());
+        queue_.pop_front();
+        stats_.queue_depth = queue_.size();
+        writing_ = true;
+        lock.unlock();
+
+        write_block(block);
+        unsynced_bytes_ += block.size;
+        block.size = 0;
+        if ((params_.sync_every_bytes != 0 && unsynced_bytes_ >= params_.sync_every_bytes) ||
+            (timed && std::chrono::steady_clock::now() - last_sync_ >= params_.sync_interval)) {
+            sync_file();
+        }
+
+        lock.lock();
+        free_blocks_.push_back(std::move(block));
+        writing_ = false;
+        cond_var_.notify_all();
+    }
+}
+
+} // namespace tiny_rx
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tiny_rx {
+
+struct AsyncFileWriterParams {
+    size_t block_size = 1024 * 1024;
+    // Full blocks waiting for the I/O thread. When the limit is reached, write() blocks
+    // until a block is written (backpressure). 1 block gives classic double buffering
+    size_t max_queued_blocks = 1;
+    // Group commit: fsync() after this many bytes are written, 0 - disabled
+    size_t sync_every_bytes = 0;
+    // Group commit: write the pending data and fsync() at least this often, 0 - disabled
+    std::chrono::milliseconds sync_interval{ 0 };
+};
+
+struct AsyncFileWriterStats {
+    std::atomic<uint64_t> bytes_written{ 0 };
+    std::atomic<uint64_t> blocks_written{ 0 };
+    std::atomic<uint64_t> syncs{ 0 };
+    std::atomic<uint64_t> last_write_latency_ns{ 0 };
+    std::atomic<uint64_t> max_write_latency_ns{ 0 };
+    std::atomic<uint64_t> total_write_latency_ns{ 0 };
+    std::atomic<size_t> queue_depth{ 0 };
+    std::atomic<size_t> max_queue_depth{ 0 };
+    // Times write() was blocked because the queue was full
+    std::atomic<uint64_t> producer_waits{ 0 };
+};
+
+// Appends data to a file from a dedicated I/O thread.
+// Callers copy data into the active block (page aligned), full blocks are queued
+// and written in background, so callers wait only when the queue is full
+class AsyncFileWriter {
+public:
+    explicit AsyncFileWriter(const std::string& path, size_t buffer_size = 1024 * 1024);
+    AsyncFileWriter(const std::string& path, AsyncFileWriterParams params);
+    ~AsyncFileWriter();
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter(AsyncFileWriter&&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(AsyncFileWriter&&) = delete;
+
+    void write(const void* data, size_t size);
+    // Blocks until all data written so far is passed to the OS
+    void flush();
+    // flush() and fsync()
+    void sync();
+
+    [[nodiscard]] const AsyncFileWriterStats& stats() const;
+
+private:
+    struct AlignedDeleter {
+        void operator()(char* p) const;
+    };
+
+    struct Block {
+        std::unique_ptr<char[], AlignedDeleter> data;
+        size_t size = 0;
+    };
+
+    Block acquire_block();
+    // Queues the active block, waiting while max_queued_blocks are queued
+    void submit(std::unique_lock<std::mutex>& lock);
+    // Queues the active block, the caller checks the queue size
+    void enqueue_active();
+    void wait_written(std::unique_lock<std::mutex>& lock);
+    void write_block(const Block& block);
+    void sync_file();
+    void run();
+
+    int fd_ = -1;
+    AsyncFileWriterParams params_;
+    AsyncFileWriterStats stats_;
+
+    Block active_;
+    std::deque<Block> queue_;
+    std::vector<Block> free_blocks_;
+    bool writing_ = false;
+    bool stop_thread_ = false;
+    uint64_t unsynced_bytes_ = 0;
+    std::chrono::steady_clock::time_point last_sync_;
+
+    std::mutex mutex_;
+    std::condition_variable cond_var_;
+    std::thread thread_;
+};
+
+} // namespace tiny_rx
@@ -0,0 +1,34 @@
+#pragma once
+
+// Internal header: kernel function tables of the batch kernels for every instruction set
+
+#include "batch_kernels.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tiny_rx::batch::detail {
+
+template<typename T>
+struct Kernels {
+    void (*add)(const T*, T*, size_t, T) = nullptr;
+    void (*multiply)(const T*, T*, size_t, T) = nullptr;
+    void (*multiply_add)(const T*, T*, size_t, T, T) = nullptr;
+    size_t (*select_greater)(const T*, T*, size_t, T) = nullptr;
+    size_t (*select_less)(const T*, T*, size_t, T) = nullptr;
+    size_t (*select_greater_indices)(const T*, size_t, T, uint32_t*) = nullptr;
+    size_t (*select_less_indices)(const T*, size_t, T, uint32_t*) = nullptr;
+    T (*reduce)(const T*, size_t, Reduction) = nullptr;
+};
+
+struct KernelTable {
+    Kernels<int> i32;
+    Kernels<float> f32;
+    Kernels<double> f64;
+};
+
+const KernelTable& scalar_kernels();
+const KernelTable& sse_kernels();
+const KernelTable& avx2_kernels();
+
+} // namespace tiny_rx::batch::detail
@@ -0,0 +1,257 @@
+#include "batch_kernels.h"
+
+#include "batch_kernel_table.h"
+
+#include <atomic>
+#include <limits>
+#include <type_traits>
+
+namespace tiny_rx::batch {
+
+namespace detail {
+
+namespace {
+
+template<typename T>
+T wrapping_add(T a, T b) {
+    if constexpr (std::is_integral_v<T>) {
+        using U = std::make_unsigned_t<T>;
+        return static_cast<T>(static_cast<U>(a) + static_cast<U>(b));
+    } else {
+        return a + b;
+    }
+}
+
+template<typename T>
+T wrapping_mul(T a, T b) {
+    if constexpr (std::is_integral_v<T>) {
+        using U = std::make_unsigned_t<T>;
+        return static_cast<T>(static_cast<U>(a) * static_cast<U>(b));
+    } else {
+        return a * b;
+    }
+}
+
+// Identities of min / max: infinities for floating point types, so infinite values
+// are reduced to themselves
+template<typename T>
+constexpr T min_identity() {
+    if constexpr (std::is_integral_v<T>)
+        return std::numeric_limits<T>::max();
+    else
+        return std::numeric_limits<T>::infinity();
+}
+
+template<typename T>
+constexpr T max_identity() {
+    if constexpr (std::is_integral_v<T>)
+        return std::numeric_limits<T>::lowest();
+    else
+        return -std::numeric_limits<T>::infinity();
+}
+
+template<typename T>
+struct ScalarKernels {
+    static void add(const T* in, T* out, size_t count, T value) {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = wrapping_add(in[i], value);
+        }
+    }
+
+    static void multiply(const T* in, T* out, size_t count, T value) {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = wrapping_mul(in[i], value);
+        }
+    }
+
+    static void multiply_add(const T* in, T* out, size_t count, T a, T b) {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = wrapping_add(wrapping_mul(in[i], a), b);
+        }
+    }
+
+    static size_t select_greater(const T* in, T* out, size_t count, T threshold) {
+        size_t selected = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (in[i] > threshold)
+                out[selected++] = in[i];
+        }
+        return selected;
+    }
+
+    static size_t select_less(const T* in, T* out, size_t count, T threshold) {
+        size_t selected = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (in[i] < threshold)
+                out[selected++] = in[i];
+        }
+        return selected;
+    }
+
+    static size_t select_greater_indices(const T* in, size_t count, T threshold, uint32_t* indices) {
+        size_t selected = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (in[i] > threshold)
+                indices[selected++] = static_cast<uint32_t>(i);
+        }
+        return selected;
+    }
+
+    static size_t select_less_indices(const T* in, size_t count, T threshold, uint32_t* indices) {
+        size_t selected = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (in[i] < threshold)
+                indices[selected++] = static_cast<uint32_t>(i);
+        }
+        return selected;
+    }
+
+    static T reduce(const T* in, size_t count, Reduction reduction) {
+        T result{};
+        switch (reduction) {
+        case Reduction::Sum:
+            for (size_t i = 0; i < count; ++i) {
+                result = wrapping_add(result, in[i]);
+            }
+            break;
+        case Reduction::Min:
+            result = min_identity<T>();
+            for (size_t i = 0; i < count; ++i) {
+                result = in[i] < result ? in[i] : result;
+            }
+            break;
+        case Reduction::Max:
+            result = max_identity<T>();
+            for (size_t i = 0; i < count; ++i) {
+                result = result < in[i] ? in[i] : result;
+            }
+            break;
+        }
+        return result;
+    }
+
+    static Kernels<T> table() {
+        Kernels<T> kernels;
+        kernels.add = &add;
+        kernels.multiply = &multiply;
+        kernels.multiply_add = &multiply_add;
+        kernels.select_greater = &select_greater;
+        kernels.select_less = &select_less;
+        kernels.select_greater_indices = &select_greater_indices;
+        kernels.select_less_indices = &select_less_indices;
+        kernels.reduce = &reduce;
+        return kernels;
+    }
+};
+
+Isa detect_isa() {
+#ifdef TINY_RX_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return Isa::Avx2;
+    if (__builtin_cpu_supports("sse4.1"))
+        return Isa::Sse;
+#endif
+    return Isa::Scalar;
+}
+
+const KernelTable& kernels_for(Isa isa) {
+    switch (isa) {
+#ifdef TINY_RX_X86_SIMD
+    case Isa::Avx2:
+        return avx2_kernels();
+    case Isa::Sse:
+        return sse_kernels();
+#endif
+    default:
+        return scalar_kernels();
+    }
+}
+
+std::atomic<const KernelTable*>& active_table() {
+    static std::atomic<const KernelTable*> table{ &kernels_for(detected_isa()) };
+    return table;
+}
+
+std::atomic<Isa>& active_isa_value() {
+    static std::atomic<Isa> isa{ detected_isa() };
+    return isa;
+}
+
+template<typename T>
+const Kernels<T>& kernels() {
+    const auto* table = active_table().load(std::memory_order_relaxed);
+    if constexpr (std::is_same_v<T, int>) {
+        return table->i32;
+    } else if constexpr (std::is_same_v<T, float>) {
+        return table->f32;
+    } else {
+        return table->f64;
+    }
+}
+
+} // namespace
+
+const KernelTable& scalar_kernels() {
+    static const KernelTable table{
+        ScalarKernels<int>::table(),
+        ScalarKernels<float>::table(),
+        ScalarKernels<double>::table()
+    };
+    return table;
+}
+
+} // namespace detail
+
+Isa detected_isa() {
+    static const Isa isa = detail::detect_isa();
+    return isa;
+}
+
+Isa active_isa() {
+    return detail::active_isa_value().load();
+}
+
+void set_active_isa(Isa isa) {
+    if (static_cast<int>(isa) > static_cast<int>(detected_isa()))
+        return;
+    detail::active_isa_value() = isa;
+    detail::active_table() = &detail::kernels_for(isa);
+}
+
+#define TINY_RX_BATCH_KERNELS(T)                                                        \
+    void add(const T* in, T* out, size_t count, T value) {                              \
+        detail::kernels<T>().add(in, out, count, value);                                \
+    }                                                                                   \
+    void multiply(const T* in, T* out, size_t count, T value) {                         \
+        detail::kernels<T>().multiply(in, out, count, value);                           \
+    }                                                                                   \
+    void multiply_add(const T* in, T* out, size_t count, T a, T b) {                    \
+        detail::kernels<T>().multiply_add(in, out, count, a, b);                        \
+    }                                                                                   \
+    size_t select_greater(const T* in, T* out, size_t count, T threshold) {             \
+        return detail::kernels<T>().select_greater(in, out, count, threshold);          \
+    }                                                                                   \
+    size_t select_less(const T* in, T* out, size_t count, T threshold) {                \
+        return detail::kernels<T>().select_less(in, out, count, threshold);             \
+    }                                                                                   \
+    size_t select_greater_indices(const T* in, size_t count, T threshold,               \
+                                  uint32_t* indices) {                                  \
+        return detail::kernels<T>().select_greater_indices(in, count, threshold,        \
+                                                           indices);                    \
+    }                                                                                   \
+    size_t select_less_indices(const T* in, size_t count, T threshold,                  \
+                               uint32_t* indices) {                                     \
+        return detail::kernels<T>().select_less_indices(in, count, threshold, indices);  \
+    }                                                                                   \
+    T reduce(const T* in, size_t count, Reduction reduction) {                          \
+        return detail::kernels<T>().reduce(in, count, reduction);                       \
+    }
+
+TINY_RX_BATCH_KERNELS(int)
+TINY_RX_BATCH_KERNELS(float)
+TINY_RX_BATCH_KERNELS(double)
+
+#undef TINY_RX_BATCH_KERNELS
+
+} // namespace tiny_rx::batch
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace tiny_rx::batch {
+
+// Instruction set used by the kernels. The best supported one is selected at
+// runtime (SSE4.1 / AVX2 on x86-64 with GCC or Clang), scalar code otherwise
+enum class Isa {
+    Scalar,
+    Sse,
+    Avx2
+};
+
+[[nodiscard]] Isa detected_isa();
+[[nodiscard]] Isa active_isa();
+// Forces a specific kernel set, e.g. to compare implementations. Isa not supported by CPU is ignored
+void set_active_isa(Isa isa);
+
+enum class Reduction {
+    Sum,
+    Min,
+    Max
+};
+
+// Element-wise kernels. `out` may be the same pointer as `in`
+void add(const int* in, int* out, size_t count, int value);
+void add(const float* in, float* out, size_t count, float value);
+void add(const double* in, double* out, size_t count, double value);
+
+void multiply(const int* in, int* out, size_t count, int value);
+void multiply(const float* in, float* out, size_t count, float value);
+void multiply(const double* in, double* out, size_t count, double value);
+
+// out[i] = in[i] * a + b
+void multiply_add(const int* in, int* out, size_t count, int a, int b);
+void multiply_add(const float* in, float* out, size_t count, float a, float b);
+void multiply_add(const double* in, double* out, size_t count, double a, double b);
+
+// Copies values passing the comparison to `out` keeping the order, returns the number of copied values
+size_t select_greater(const int* in, int* out, size_t count, int threshold);
+size_t select_greater(const float* in, float* out, size_t count, float threshold);
+size_t select_greater(const double* in, double* out, size_t count, double threshold);
+
+size_t select_less(const int* in, int* out, size_t count, int threshold);
+size_t select_less(const float* in, float* out, size_t count, float threshold);
+size_t select_less(const double* in, double* out, size_t count, double threshold);
+
+// Writes indices of values passing the comparison to `indices` (must fit `count` values),
+// returns the number of written indices
+size_t select_greater_indices(const int* in, size_t count, int threshold, uint32_t* indices);
+size_t select_greater_indices(const float* in, size_t count, float threshold, uint32_t* indices);
+size_t select_greater_indices(const double* in, size_t count, double threshold, uint32_t* indices);
+
+size_t select_less_indices(const int* in, size_t count, int threshold, uint32_t* indices);
+size_t select_less_indices(const float* in, size_t count, float threshold, uint32_t* indices);
+size_t select_less_indices(const double* in, size_t count, double threshold, uint32_t* indices);
+
+// Sum of an empty range is 0, min/max of an empty range is +inf/-inf for floating point
+// types and the type's max/lowest value for int.
+// Integer sum wraps around on overflow. Floating point sum may differ from sequential
+// summation in the last bits, because values are added in several lanes
+int reduce(const int* in, size_t count, Reduction reduction);
+float reduce(const float* in, size_t count, Reduction reduction);
+double reduce(const double* in, size_t count, Reduction reduction);
+
+template<typename T>
+inline constexpr bool is_kernel_type_v = std::is_same_v<T, int> || std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+template<typename T>
+struct is_batch : std::false_type {};
+
+template<typename T>
+struct is_batch<std::vector<T>> : std::bool_constant<is_kernel_type_v<T>> {};
+
+template<typename T>
+inline constexpr bool is_batch_v = is_batch<T>::value;
+
+// Callables for map() on observables of batches (std::vector<int|float|double>), e.g.
+// source.map(tiny_rx::batch::ops::multiply(2.0f))
+namespace ops {
+
+template<typename T>
+auto add(T value) {
+    return [value](std::vector<T> values) {
+        batch::add(values.data(), values.data(), values.size(), value);
+        return values;
+    };
+}
+
+template<typename T>
+auto multiply(T value) {
+    return [value](std::vector<T> values) {
+        batch::multiply(values.data(), values.data(), values.size(), value);
+        return values;
+    };
+}
+
+template<typename T>
+auto multiply_add(T a, T b) {
+    return [a, b](std::vector<T> values) {
+        batch::multiply_add(values.data(), values.data(), values.size(), a, b);
+        return values;
+    };
+}
+
+// Filters values inside of a batch
+template<typename T>
+auto select_greater(T threshold) {
+    return [threshold](std::vector<T> values) {
+        values.resize(batch::select_greater(values.data(), values.data(), values.size(), threshold));
+        return values;
+    };
+}
+
+template<typename T>
+auto select_less(T threshold) {
+    return [threshold](std::vector<T> values) {
+        values.resize(batch::select_less(values.data(), values.data(), values.size(), threshold));
+        return values;
+    };
+}
+
+} // namespace ops
+
+} // namespace tiny_rx::batch
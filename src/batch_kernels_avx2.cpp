@@ -0,0 +1,84 @@
+// Compiled with -mavx2
+#include "batch_kernels_impl.h"
+
+#include <climits>
+#include <limits>
+
+#include <immintrin.h>
+
+namespace tiny_rx::batch::detail {
+
+namespace {
+
+struct Avx2Int {
+    using T = int;
+    using Reg = __m256i;
+    static constexpr size_t kWidth = 8;
+    static constexpr T kMinIdentity = INT_MAX;
+    static constexpr T kMaxIdentity = INT_MIN;
+    static Reg load(const T* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static void store(T* p, Reg v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    static Reg set1(T v) { return _mm256_set1_epi32(v); }
+    static Reg add(Reg a, Reg b) { return _mm256_add_epi32(a, b); }
+    static Reg mul(Reg a, Reg b) { return _mm256_mullo_epi32(a, b); }
+    static Reg min(Reg a, Reg b) { return _mm256_min_epi32(a, b); }
+    static Reg max(Reg a, Reg b) { return _mm256_max_epi32(a, b); }
+    static unsigned greater_mask(Reg a, Reg b) {
+        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(a, b))));
+    }
+    static T scalar_add(T a, T b) { return wrapping_add(a, b); }
+    static T scalar_mul(T a, T b) { return wrapping_mul(a, b); }
+};
+
+struct Avx2Float {
+    using T = float;
+    using Reg = __m256;
+    static constexpr size_t kWidth = 8;
+    static constexpr T kMinIdentity = std::numeric_limits<T>::infinity();
+    static constexpr T kMaxIdentity = -std::numeric_limits<T>::infinity();
+    static Reg load(const T* p) { return _mm256_loadu_ps(p); }
+    static void store(T* p, Reg v) { _mm256_storeu_ps(p, v); }
+    static Reg set1(T v) { return _mm256_set1_ps(v); }
+    static Reg add(Reg a, Reg b) { return _mm256_add_ps(a, b); }
+    static Reg mul(Reg a, Reg b) { return _mm256_mul_ps(a, b); }
+    static Reg min(Reg a, Reg b) { return _mm256_min_ps(a, b); }
+    static Reg max(Reg a, Reg b) { return _mm256_max_ps(a, b); }
+    static unsigned greater_mask(Reg a, Reg b) {
+        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_GT_OQ)));
+    }
+    static T scalar_add(T a, T b) { return a + b; }
+    static T scalar_mul(T a, T b) { return a * b; }
+};
+
+struct Avx2Double {
+    using T = double;
+    using Reg = __m256d;
+    static constexpr size_t kWidth = 4;
+    static constexpr T kMinIdentity = std::numeric_limits<T>::infinity();
+    static constexpr T kMaxIdentity = -std::numeric_limits<T>::infinity();
+    static Reg load(const T* p) { return _mm256_loadu_pd(p); }
+    static void store(T* p, Reg v) { _mm256_storeu_pd(p, v); }
+    static Reg set1(T v) { return _mm256_set1_pd(v); }
+    static Reg add(Reg a, Reg b) { return _mm256_add_pd(a, b); }
+    static Reg mul(Reg a, Reg b) { return _mm256_mul_pd(a, b); }
+    static Reg min(Reg a, Reg b) { return _mm256_min_pd(a, b); }
+    static Reg max(Reg a, Reg b) { return _mm256_max_pd(a, b); }
+    static unsigned greater_mask(Reg a, Reg b) {
+        return static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_GT_OQ)));
+    }
+    static T scalar_add(T a, T b) { return a + b; }
+    static T scalar_mul(T a, T b) { return a * b; }
+};
+
+} // namespace
+
+const KernelTable& avx2_kernels() {
+    static const KernelTable table{
+        VectorKernels<Avx2Int>::table(),
+        VectorKernels<Avx2Float>::table(),
+        VectorKernels<Avx2Double>::table()
+    };
+    return table;
+}
+
+} // namespace tiny_rx::batch::detail
@@ -0,0 +1,176 @@
+#pragma once
+
+// Internal header: generic vectorized kernels, instantiated in ISA-specific
+// translation units (batch_kernels_sse.cpp, batch_kernels_avx2.cpp) compiled
+// with the corresponding compiler flags. Keep standard library templates out
+// of these units: their instances could be picked by the linker for other units
+
+#include "batch_kernel_table.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tiny_rx::batch::detail {
+
+// Internal linkage: every ISA unit gets its own instances
+namespace {
+
+// Generic kernels over a vector traits type V providing:
+// T, Reg, kWidth, load(), store(), set1(), add(), mul(), min(), max(),
+// greater_mask(a, b) - bit i is set if a[i] > b[i]
+template<typename V>
+struct VectorKernels {
+    using T = typename V::T;
+    using Reg = typename V::Reg;
+    static constexpr size_t kWidth = V::kWidth;
+
+    static void add(const T* in, T* out, size_t count, T value) {
+        const Reg v = V::set1(value);
+        size_t i = 0;
+        for (; i + kWidth <= count; i += kWidth) {
+            V::store(out + i, V::add(V::load(in + i), v));
+        }
+        for (; i < count; ++i) {
+            out[i] = V::scalar_add(in[i], value);
+        }
+    }
+
+    static void multiply(const T* in, T* out, size_t count, T value) {
+        const Reg v = V::set1(value);
+        size_t i = 0;
+        for (; i + kWidth <= count; i += kWidth) {
+            V::store(out + i, V::mul(V::load(in + i), v));
+        }
+        for (; i < count; ++i) {
+            out[i] = V::scalar_mul(in[i], value);
+        }
+    }
+
+    static void multiply_add(const T* in, T* out, size_t count, T a, T b) {
+        const Reg va = V::set1(a);
+        const Reg vb = V::set1(b);
+        size_t i = 0;
+        for (; i + kWidth <= count; i += kWidth) {
+            V::store(out + i, V::add(V::mul(V::load(in + i), va), vb));
+        }
+        for (; i < count; ++i) {
+            out[i] = V::scalar_add(V::scalar_mul(in[i], a), b);
+        }
+    }
+
+    template<bool Greater>
+    static size_t select(const T* in, T* out, size_t count, T threshold) {
+        const Reg t = V::set1(threshold);
+        size_t i = 0;
+        size_t selected = 0;
+        for (; i + kWidth <= count; i += kWidth) {
+            const Reg values = V::load(in + i);
+            unsigned mask = Greater ? V::greater_mask(values, t) : V::greater_mask(t, values);
+            while (mask != 0) {
+                const auto lane = static_cast<size_t>(__builtin_ctz(mask));
+                out[selected++] = in[i + lane];
+                mask &= mask - 1;
+            }
+        }
+        for (; i < count; ++i) {
+            if (Greater ? in[i] > threshold : in[i] < threshold)
+                out[selected++] = in[i];
+        }
+        return selected;
+    }
+
+    static size_t select_greater(const T* in, T* out, size_t count, T threshold) {
+        return select<true>(in, out, count, threshold);
+    }
+
+    static size_t select_less(const T* in, T* out, size_t count, T threshold) {
+        return select<false>(in, out, count, threshold);
+    }
+
+    template<bool Greater>
+    static size_t select_indices(const T* in, size_t count, T threshold, uint32_t* indices) {
+        const Reg t = V::set1(threshold);
+        size_t i = 0;
+        size_t selected = 0;
+        for (; i + kWidth <= count; i += kWidth) {
+            const Reg values = V::load(in + i);
+            unsigned mask = Greater ? V::greater_mask(values, t) : V::greater_mask(t, values);
+            while (mask != 0) {
+                indices[selected++] = static_cast<uint32_t>(i + static_cast<size_t>(__builtin_ctz(mask)));
+                mask &= mask - 1;
+            }
+        }
+        for (; i < count; ++i) {
+            if (Greater ? in[i] > threshold : in[i] < threshold)
+                indices[selected++] = static_cast<uint32_t>(i);
+        }
+        return selected;
+    }
+
+    static size_t select_greater_indices(const T* in, size_t count, T threshold, uint32_t* indices) {
+        return select_indices<true>(in, count, threshold, indices);
+    }
+
+    static size_t select_less_indices(const T* in, size_t count, T threshold, uint32_t* indices) {
+        return select_indices<false>(in, count, threshold, indices);
+    }
+
+    static T reduce(const T* in, size_t count, Reduction reduction) {
+        const T identity = reduction == Reduction::Sum ? T{} : (reduction == Reduction::Min ? V::kMinIdentity : V::kMaxIdentity);
+        Reg acc = V::set1(identity);
+        size_t i = 0;
+        for (; i + kWidth <= count; i += kWidth) {
+            const Reg values = V::load(in + i);
+            switch (reduction) {
+            case Reduction::Sum: acc = V::add(acc, values); break;
+            case Reduction::Min: acc = V::min(acc, values); break;
+            case Reduction::Max: acc = V::max(acc, values); break;
+            }
+        }
+
+        T lanes[kWidth];
+        V::store(lanes, acc);
+        T result = identity;
+        auto fold = [reduction](T a, T b) {
+            switch (reduction) {
+            case Reduction::Sum: return V::scalar_add(a, b);
+            case Reduction::Min: return b < a ? b : a;
+            case Reduction::Max: return a < b ? b : a;
+            }
+            return a;
+        };
+        for (size_t lane = 0; lane < kWidth; ++lane) {
+            result = fold(result, lanes[lane]);
+        }
+        for (; i < count; ++i) {
+            result = fold(result, in[i]);
+        }
+        return result;
+    }
+
+    static Kernels<T> table() {
+        Kernels<T> kernels;
+        kernels.add = &add;
+        kernels.multiply = &multiply;
+        kernels.multiply_add = &multiply_add;
+        kernels.select_greater = &select_greater;
+        kernels.select_less = &select_less;
+        kernels.select_greater_indices = &select_greater_indices;
+        kernels.select_less_indices = &select_less_indices;
+        kernels.reduce = &reduce;
+        return kernels;
+    }
+};
+
+// Integer arithmetic wraps around, as the vector instructions do
+inline int wrapping_add(int a, int b) {
+    return static_cast<int>(static_cast<unsigned>(a) + static_cast<unsigned>(b));
+}
+
+inline int wrapping_mul(int a, int b) {
+    return static_cast<int>(static_cast<unsigned>(a) * static_cast<unsigned>(b));
+}
+
+} // namespace
+
+} // namespace tiny_rx::batch::detail
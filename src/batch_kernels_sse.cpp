@@ -0,0 +1,80 @@
+// Compiled with -msse4.1
+#include "batch_kernels_impl.h"
+
+#include <climits>
+#include <limits>
+
+#include <immintrin.h>
+
+namespace tiny_rx::batch::detail {
+
+namespace {
+
+struct SseInt {
+    using T = int;
+    using Reg = __m128i;
+    static constexpr size_t kWidth = 4;
+    static constexpr T kMinIdentity = INT_MAX;
+    static constexpr T kMaxIdentity = INT_MIN;
+    static Reg load(const T* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static void store(T* p, Reg v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static Reg set1(T v) { return _mm_set1_epi32(v); }
+    static Reg add(Reg a, Reg b) { return _mm_add_epi32(a, b); }
+    static Reg mul(Reg a, Reg b) { return _mm_mullo_epi32(a, b); }
+    static Reg min(Reg a, Reg b) { return _mm_min_epi32(a, b); }
+    static Reg max(Reg a, Reg b) { return _mm_max_epi32(a, b); }
+    static unsigned greater_mask(Reg a, Reg b) {
+        return static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(a, b))));
+    }
+    static T scalar_add(T a, T b) { return wrapping_add(a, b); }
+    static T scalar_mul(T a, T b) { return wrapping_mul(a, b); }
+};
+
+struct SseFloat {
+    using T = float;
+    using Reg = __m128;
+    static constexpr size_t kWidth = 4;
+    static constexpr T kMinIdentity = std::numeric_limits<T>::infinity();
+    static constexpr T kMaxIdentity = -std::numeric_limits<T>::infinity();
+    static Reg load(const T* p) { return _mm_loadu_ps(p); }
+    static void store(T* p, Reg v) { _mm_storeu_ps(p, v); }
+    static Reg set1(T v) { return _mm_set1_ps(v); }
+    static Reg add(Reg a, Reg b) { return _mm_add_ps(a, b); }
+    static Reg mul(Reg a, Reg b) { return _mm_mul_ps(a, b); }
+    static Reg min(Reg a, Reg b) { return _mm_min_ps(a, b); }
+    static Reg max(Reg a, Reg b) { return _mm_max_ps(a, b); }
+    static unsigned greater_mask(Reg a, Reg b) { return static_cast<unsigned>(_mm_movemask_ps(_mm_cmpgt_ps(a, b))); }
+    static T scalar_add(T a, T b) { return a + b; }
+    static T scalar_mul(T a, T b) { return a * b; }
+};
+
+struct SseDouble {
+    using T = double;
+    using Reg = __m128d;
+    static constexpr size_t kWidth = 2;
+    static constexpr T kMinIdentity = std::numeric_limits<T>::infinity();
+    static constexpr T kMaxIdentity = -std::numeric_limits<T>::infinity();
+    static Reg load(const T* p) { return _mm_loadu_pd(p); }
+    static void store(T* p, Reg v) { _mm_storeu_pd(p, v); }
+    static Reg set1(T v) { return _mm_set1_pd(v); }
+    static Reg add(Reg a, Reg b) { return _mm_add_pd(a, b); }
+    static Reg mul(Reg a, Reg b) { return _mm_mul_pd(a, b); }
+    static Reg min(Reg a, Reg b) { return _mm_min_pd(a, b); }
+    static Reg max(Reg a, Reg b) { return _mm_max_pd(a, b); }
+    static unsigned greater_mask(Reg a, Reg b) { return static_cast<unsigned>(_mm_movemask_pd(_mm_cmpgt_pd(a, b))); }
+    static T scalar_add(T a, T b) { return a + b; }
+    static T scalar_mul(T a, T b) { return a * b; }
+};
+
+} // namespace
+
+const KernelTable& sse_kernels() {
+    static const KernelTable table{
+        VectorKernels<SseInt>::table(),
+        VectorKernels<SseFloat>::table(),
+        VectorKernels<SseDouble>::table()
+    };
+    return table;
+}
+
+} // namespace tiny_rx::batch::detail
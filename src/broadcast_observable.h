@@ -0,0 +1,342 @@
+#pragma once
+
+#include "iobservable.h"
+#include "log.h"
+#include "subscription.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace tiny_rx {
+
+enum class BroadcastWaitStrategy {
+    BusySpin,  // lowest latency, a core per consumer
+    Yield,     // spin with std::this_thread::yield()
+    Blocking   // spin shortly, then sleep until the producer publishes
+};
+
+struct BroadcastParams {
+    size_t capacity = 1024;  // rounded up to a power of two
+    size_t max_consumers = 8;
+    BroadcastWaitStrategy wait_strategy = BroadcastWaitStrategy::Blocking;
+};
+
+// Single producer, multiple consumers fan-out (disruptor-style).
+// Events are written once into a preallocated ring buffer, every subscriber runs
+// on its own thread and reads them in place, tracking its position with a sequence
+// cursor. The producer waits (spinning / yielding) when the slowest consumer is
+// `capacity` events behind, so the memory footprint is bounded.
+// Publishing an event takes no locks and allocates nothing (values are copy-assigned
+// into the slot, so e.g. std::string reuses its buffer).
+// next(), end() and error() must be called from one thread at a time.
+// Handlers receive references to the slot, which are valid during the call only
+template<typename ...T>
+class BroadcastObservable : public IObservable {
+    static_assert((std::is_default_constructible_v<T> && ...), "BroadcastObservable requires default constructible values");
+
+public:
+    explicit BroadcastObservable(BroadcastParams params = {})
+        : params_{ params }
+        , mask_{ round_up_pow2(params.capacity) - 1 }
+        , slots_(mask_ + 1)
+        , consumers_(params.max_consumers) {
+        if (params.capacity == 0 || params.max_consumers == 0)
+            throw std::invalid_argument("BroadcastObservable: capacity and max_consumers should be positive");
+    }
+
+    ~BroadcastObservable() override {
+        for (auto& consumer : consumers_)
+            stop_consumer(consumer);
+        if (valid_)
+            *valid_ = false;
+    }
+
+    BroadcastObservable(const BroadcastObservable&) = delete;
+    BroadcastObservable(BroadcastObservable&&) = delete;
+    BroadcastObservable& operator=(const BroadcastObservable&) = delete;
+    BroadcastObservable& operator=(BroadcastObservable&&) = delete;
+
+    template<typename F, std::enable_if_t<std::is_object_v<F>, bool> = true>
+    Subscription subscribe(std::shared_ptr<F> object) {
+        return subscribe(
+            [object](const T&... args) { object->on_next(args...); },
+            [object]() { object->on_end(); },
+            [object](const std::string& descr) { object->on_error(descr); }
+        );
+    }
+
+    // Starts a consumer thread receiving events published after this call.
+    // Throws std::runtime_error when all max_consumers slots are taken
+    template<typename ...F>
+    Subscription subscribe(F&&... args) {
+        constexpr std::size_t size = sizeof...(F);
+        std::lock_guard<std::mutex> lock(consumers_mutex_);
+
+        auto free_slot = std::find_if(consumers_.begin(), consumers_.end(), [](const Consumer& c) { return !c.active; });
+        if (free_slot == consumers_.end())
+            throw std::runtime_error("BroadcastObservable: no free consumer slots");
+        auto& consumer = *free_slot;
+        // Thread of a consumer unsubscribed from its own handler
+        if (consumer.thread.joinable())
+            consumer.thread.join();
+
+        auto params = std::tuple<F...>(std::forward<F>(args)...);
+        consumer.on_next = std::move(std::get<0>(params));
+        consumer.on_end = nullptr;
+        consumer.on_error = nullptr;
+        if constexpr (size > 1)
+            consumer.on_end = std::move(std::get<1>(params));
+        if constexpr (size > 2)
+            consumer.on_error = std::move(std::get<2>(params));
+
+        consumer.uuid = Guid();
+        consumer.stop = false;
+        consumer.active = true;
+        // Gates the producer from now on: the cursor is visible before the consumer
+        // starts, and the consumer starts right after the gated sequence
+        const auto published = published_.load();
+        consumer.cursor = published;
+        const auto first_seq = published + 1;
+        consumer.thread = std::thread([this, &consumer, first_seq]() { run_consumer(consumer, first_seq); });
+
+        // Subscriptions outliving the observable see it invalidated
+        if (!valid_)
+            valid_ = std::make_shared<bool>(true);
+        return Subscription(this, consumer.uuid, valid_);
+    }
+
+    void unsubscribe(const Guid& uuid) override {
+        std::lock_guard<std::mutex> lock(consumers_mutex_);
+        for (auto& consumer : consumers_) {
+            if (consumer.active && consumer.uuid == uuid) {
+                stop_consumer(consumer);
+                break;
+            }
+        }
+    }
+
+    std::optional<Subscription> get_linked_subscription() override {
+        return std::nullopt;
+    }
+
+    [[nodiscard]] size_t subscribers_count() const override {
+        std::lock_guard<std::mutex> lock(consumers_mutex_);
+        return static_cast<size_t>(std::count_if(consumers_.begin(), consumers_.end(), [](const Consumer& c) {
+            return c.active && !c.stop;
+        }));
+    }
+
+    void next(const T&... value) {
+        auto& slot = claim();
+        slot.kind = EventKind::Value;
+        slot.value = std::tie(value...);
+        publish();
+    }
+
+    void end() {
+        auto& slot = claim();
+        slot.kind = EventKind::End;
+        publish();
+    }
+
+    void error(const std::string& descr) {
+        auto& slot = claim();
+        slot.kind = EventKind::Error;
+        slot.descr = descr;
+        publish();
+    }
+
+    [[nodiscard]] size_t capacity() const {
+        return mask_ + 1;
+    }
+
+    // Number of events published so far
+    [[nodiscard]] uint64_t published() const {
+        return static_cast<uint64_t>(published_.load(std::memory_order_acquire) + 1);
+    }
+
+    // Number of times the producer had to wait for slow consumers
+    [[nodiscard]] uint64_t producer_waits() const {
+        return producer_waits_.load(std::memory_order_relaxed);
+    }
+
+private:
+    enum class EventKind : uint8_t {
+        Value,
+        End,
+        Error
+    };
+
+    struct Slot {
+        std::tuple<T...> value;
+        std::string descr;
+        EventKind kind{ EventKind::Value };
+    };
+
+    static constexpr int64_t kIdleCursor = std::numeric_limits<int64_t>::max();
+    static constexpr size_t kSpinCount = 256;
+    static constexpr size_t kYieldCount = 64;
+
+    struct alignas(64) Consumer {
+        // Last sequence processed, kIdleCursor when the slot is free (doesn't gate the producer)
+        std::atomic<int64_t> cursor{ kIdleCursor };
+        std::atomic<bool> stop{ false };
+        bool active{ false };
+        Guid uuid;
+        std::thread thread;
+        std::function<void(const T&...)> on_next;
+        std::function<void()> on_end;
+        std::function<void(const std::string&)> on_error;
+    };
+
+    static size_t round_up_pow2(size_t value) {
+        size_t res = 1;
+        while (res < value)
+            res <<= 1;
+        return res;
+    }
+
+    // Waits until the slowest consumer frees the slot for the next sequence
+    Slot& claim() {
+        const auto seq = next_seq_;
+        const auto wrap_point = seq - static_cast<int64_t>(capacity());
+        if (wrap_point > gate_cache_) {
+            size_t iteration = 0;
+            // The cache never goes beyond the last published sequence,
+            // as consumers subscribing later start after it
+            while (wrap_point > (gate_cache_ = std::min(min_cursor(), seq - 1))) {
+                if (iteration++ == 0)
+                    producer_waits_.fetch_add(1, std::memory_order_relaxed);
+                if (params_.wait_strategy != BroadcastWaitStrategy::BusySpin)
+                    std::this_thread::yield();
+            }
+        }
+        return slots_[static_cast<size_t>(seq) & mask_];
+    }
+
+    void publish() {
+        published_.store(next_seq_++);
+        if (sleeping_consumers_.load() != 0) {
+            std::lock_guard<std::mutex> lock(wait_mutex_);
+            wait_cond_var_.notify_all();
+        }
+    }
+
+    [[nodiscard]] int64_t min_cursor() const {
+        int64_t res = kIdleCursor;
+        for (const auto& consumer : consumers_)
+            res = std::min(res, consumer.cursor.load(std::memory_order_acquire));
+        return res;
+    }
+
+    // Returns the last published sequence (>= seq) or a smaller one if stopped
+    int64_t wait_for(int64_t seq, const Consumer& consumer) {
+        for (size_t i = 0; ; ++i) {
+            const auto available = published_.load(std::memory_order_acquire);
+            if (available >= seq || consumer.stop)
+                return available;
+            if (params_.wait_strategy == BroadcastWaitStrategy::BusySpin || i < kSpinCount)
+                continue;
+            if (params_.wait_strategy == BroadcastWaitStrategy::Yield || i < kSpinCount + kYieldCount) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            sleeping_consumers_.fetch_add(1);
+            wait_cond_var_.wait(lock, [this, seq, &consumer]() {
+                return published_.load() >= seq || consumer.stop;
+            });
+            sleeping_consumers_.fetch_sub(1);
+        }
+    }
+
+    void run_consumer(Consumer& consumer, int64_t seq) {
+        bool finished = false;
+        while (!consumer.stop) {
+            const auto available = wait_for(seq, consumer);
+            // Events are handled in batches, the cursor is advanced once per batch
+            for (; seq <= available && !consumer.stop; ++seq) {
+                if (!finished)
+                    finished = dispatch(consumer, slots_[static_cast<size_t>(seq) & mask_]);
+            }
+            if (!consumer.stop)
+                consumer.cursor.store(seq - 1, std::memory_order_release);
+        }
+    }
+
+    // Returns true if the stream is finished
+    bool dispatch(Consumer& consumer, const Slot& slot) {
+        try {
+            switch (slot.kind) {
+            case EventKind::Value:
+                std::apply(consumer.on_next, slot.value);
+                return false;
+            case EventKind::End:
+                if (consumer.on_end)
+                    consumer.on_end();
+                return true;
+            case EventKind::Error:
+                if (consumer.on_error)
+                    consumer.on_error(slot.descr);
+                return true;
+            }
+        } catch (const std::exception& e) {
+            log(utils::LogSeverity::Error, "BroadcastObservable exception in consumer: ", e.what());
+        }
+        return false;
+    }
+
+    // Should be called with consumers_mutex_ locked (or from the destructor)
+    void stop_consumer(Consumer& consumer) {
+        const bool own_thread = consumer.thread.get_id() == std::this_thread::get_id();
+        if (!consumer.active) {
+            if (consumer.thread.joinable() && !own_thread)
+                consumer.thread.join();
+            return;
+        }
+        consumer.stop = true;
+        {
+            std::lock_guard<std::mutex> lock(wait_mutex_);
+            wait_cond_var_.notify_all();
+        }
+        // Unsubscribing from the consumer's own handler: the thread exits by itself
+        // and is joined when the slot is reused
+        if (consumer.thread.joinable() && !own_thread)
+            consumer.thread.join();
+        consumer.cursor = kIdleCursor;
+        consumer.active = false;
+    }
+
+    BroadcastParams params_;
+    size_t mask_;
+    std::vector<Slot> slots_;
+    std::vector<Consumer> consumers_;
+    mutable std::mutex consumers_mutex_;
+    std::shared_ptr<bool> valid_;
+
+    // Producer side
+    alignas(64) std::atomic<int64_t> published_{ -1 };
+    alignas(64) int64_t next_seq_{ 0 };
+    int64_t gate_cache_{ -1 };
+    std::atomic<uint64_t> producer_waits_{ 0 };
+
+    // Blocking wait strategy
+    std::atomic<size_t> sleeping_consumers_{ 0 };
+    std::mutex wait_mutex_;
+    std::condition_variable wait_cond_var_;
+};
+
+} // namespace tiny_rx
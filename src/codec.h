@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace tiny_rx {
+
+// Binary encoding of values for stream recording.
+// Arithmetic types, enums, std::string and std::string_view are supported out of
+// the box, specialize Codec<T> with the same interface for other types.
+// Values are stored in the native byte order
+template<typename T, typename Enable = void>
+struct Codec {
+    static_assert(sizeof(T) == 0, "No Codec<T> specialization for the type");
+};
+
+// Types recorded as their bytes. Pointers are never recorded, as the addresses would
+// dangle on replay; a trivially copyable struct may hold some, so it's recorded only
+// when opted in: template<> struct is_bitwise_recordable<Point> : std::true_type {};
+template<typename T>
+struct is_bitwise_recordable : std::bool_constant<std::is_arithmetic_v<T> || std::is_enum_v<T>> {};
+
+template<typename T>
+inline constexpr bool is_bitwise_recordable_v = is_bitwise_recordable<T>::value;
+
+template<typename T>
+struct Codec<T, std::enable_if_t<is_bitwise_recordable_v<T>>> {
+    static_assert(std::is_trivially_copyable_v<T> && !std::is_pointer_v<T> && !std::is_member_pointer_v<T>,
+                  "Only trivially copyable types without pointers can be recorded as bytes");
+
+    static void encode(const T& value, std::vector<char>& out) {
+        const auto* bytes = reinterpret_cast<const char*>(&value);
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    static T decode(const char*& data, const char* end) {
+        if (static_cast<size_t>(end - data) < sizeof(T))
+            throw std::runtime_error("Codec: unexpected end of data");
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        data += sizeof(T);
+        return value;
+    }
+};
+
+template<typename T>
+struct Codec<T, std::enable_if_t<std::is_trivially_copyable_v<T> && !is_bitwise_recordable_v<T>
+    && !std::is_same_v<T, std::string_view>>> {
+    static_assert(sizeof(T) == 0, "Pointers can't be recorded: encode the values they point to, "
+                  "or specialize is_bitwise_recordable<T> for a struct without pointers");
+};
+
+template<>
+struct Codec<std::string> {
+    static void encode(const std::string& value, std::vector<char>& out) {
+        Codec<uint32_t>::encode(static_cast<uint32_t>(value.size()), out);
+        out.insert(out.end(), value.begin(), value.end());
+    }
+
+    static std::string decode(const char*& data, const char* end) {
+        const auto size = Codec<uint32_t>::decode(data, end);
+        if (static_cast<size_t>(end - data) < size)
+            throw std::runtime_error("Codec: unexpected end of data");
+        std::string value(data, size);
+        data += size;
+        return value;
+    }
+};
+
+// Written as the bytes of the view. Decoded views point into the replayed log,
+// so they are valid while the StreamReplayer exists
+template<>
+struct Codec<std::string_view> {
+    static void encode(std::string_view value, std::vector<char>& out) {
+        Codec<uint32_t>::encode(static_cast<uint32_t>(value.size()), out);
+        out.insert(out.end(), value.begin(), value.end());
+    }
+
+    static std::string_view decode(const char*& data, const char* end) {
+        const auto size = Codec<uint32_t>::decode(data, end);
+        if (static_cast<size_t>(end - data) < size)
+            throw std::runtime_error("Codec: unexpected end of data");
+        std::string_view value(data, size);
+        data += size;
+        return value;
+    }
+};
+
+} // namespace tiny_rx
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "demand.h"
+#include "observable.h"
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <tuple>
+#include <utility>
+
+namespace tiny_rx {
+
+// Source producing values on demand. Values are taken from the generator only while
+// the observable's subscribers have outstanding demand (see Observable::with_demand()
+// and Subscription::request()), emission resumes when more values are requested.
+// Without subscribers in the demand mode all values are emitted at once.
+// end() is called when the generator is exhausted, error() if it throws
+template<typename ...T>
+class ColdSource {
+public:
+    using Generator = std::function<std::optional<std::tuple<T...>>()>;
+
+    ColdSource(Observable<T...>& observable, Generator generator)
+        : observable_{ observable }
+        , generator_{ std::move(generator) } {
+        observable_.set_on_demand([this](uint64_t) { pump(); });
+    }
+
+    ~ColdSource() {
+        observable_.set_on_demand(nullptr);
+    }
+
+    ColdSource(const ColdSource&) = delete;
+    ColdSource(ColdSource&&) = delete;
+    ColdSource& operator=(const ColdSource&) = delete;
+    ColdSource& operator=(ColdSource&&) = delete;
+
+    // Emits values up to the current demand
+    void start() {
+        pump();
+    }
+
+    [[nodiscard]] bool finished() const {
+        return finished_;
+    }
+
+    // Generator of `count` values starting with `first`
+    template<typename V>
+    static Generator range(V first, size_t count) {
+        return [current = first, remaining = count]() mutable -> std::optional<std::tuple<T...>> {
+            if (remaining == 0)
+                return std::nullopt;
+            --remaining;
+            return std::make_tuple(current++);
+        };
+    }
+
+private:
+    void pump() {
+        // Requests may come from subscribers while values are emitted (even from
+        // other threads): only the thread that raised the counter from zero emits,
+        // the others leave their increment to make it recheck the demand
+        if (wip_.fetch_add(1, std::memory_order_acq_rel) != 0)
+            return;
+        try {
+            do {
+                emit_available();
+            } while (wip_.fetch_sub(1, std::memory_order_acq_rel) != 1);
+        } catch (...) {
+            // A subscriber threw: let the next request emit again
+            wip_.store(0, std::memory_order_release);
+            throw;
+        }
+    }
+
+    // A generator exception ends the stream with error()
+    void emit_available() {
+        while (!finished_ && observable_.demand() != 0) {
+            std::optional<std::tuple<T...>> values;
+            try {
+                values = generator_();
+            } catch (const std::exception& e) {
+                finished_ = true;
+                observable_.error(e.what());
+                return;
+            }
+            if (!values) {
+                finished_ = true;
+                observable_.end();
+                return;
+            }
+            std::apply([this](const T&... args) { observable_.next(args...); }, *values);
+        }
+    }
+
+    Observable<T...>& observable_;
+    Generator generator_;
+    std::atomic<bool> finished_{ false };
+    // Pending pump() calls, the first one emits
+    std::atomic<uint64_t> wip_{ 0 };
+};
+
+} // namespace tiny_rx
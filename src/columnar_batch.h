@@ -0,0 +1,125 @@
+#pragma once
+
+#include "batch_kernels.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace tiny_rx {
+
+// Batch of multi-value events stored column by column: one contiguous std::vector
+// per value type. Operators working with a single column read only that column's memory
+template<typename ...T>
+class ColumnarBatch {
+public:
+    template<size_t N>
+    using ColumnType = std::tuple_element_t<N, std::tuple<T...>>;
+
+    void reserve(size_t count) {
+        std::apply([count](auto&... columns) { (columns.reserve(count), ...); }, columns_);
+    }
+
+    void push_back(const T&... values) {
+        push_back_impl(std::index_sequence_for<T...>{}, values...);
+    }
+
+    void clear() {
+        std::apply([](auto&... columns) { (columns.clear(), ...); }, columns_);
+    }
+
+    [[nodiscard]] size_t size() const {
+        return std::get<0>(columns_).size();
+    }
+
+    [[nodiscard]] bool empty() const {
+        return size() == 0;
+    }
+
+    template<size_t N>
+    [[nodiscard]] const std::vector<ColumnType<N>>& column() const {
+        return std::get<N>(columns_);
+    }
+
+    template<size_t N>
+    [[nodiscard]] std::vector<ColumnType<N>>& column() {
+        return std::get<N>(columns_);
+    }
+
+    [[nodiscard]] std::tuple<T...> row(size_t index) const {
+        return std::apply([index](const auto&... columns) { return std::make_tuple(columns[index]...); }, columns_);
+    }
+
+    // Keeps rows with given indices (ascending) in every column
+    void keep_rows(const uint32_t* indices, size_t count) {
+        if (count == size())
+            return;
+        std::apply([indices, count](auto&... columns) {
+            (keep_column_rows(columns, indices, count), ...);
+        }, columns_);
+    }
+
+    bool operator==(const ColumnarBatch& other) const {
+        return columns_ == other.columns_;
+    }
+
+private:
+    template<size_t ...N>
+    void push_back_impl(std::index_sequence<N...>, const T&... values) {
+        (std::get<N>(columns_).push_back(values), ...);
+    }
+
+    template<typename C>
+    static void keep_column_rows(std::vector<C>& column, const uint32_t* indices, size_t count) {
+        // Indices are ascending, so compaction in place never overwrites unread rows
+        for (size_t i = 0; i < count; ++i) {
+            if (indices[i] != i)
+                column[i] = std::move(column[indices[i]]);
+        }
+        column.resize(count);
+    }
+
+    std::tuple<std::vector<T>...> columns_;
+};
+
+template<typename T>
+struct is_columnar_batch : std::false_type {};
+
+template<typename ...T>
+struct is_columnar_batch<ColumnarBatch<T...>> : std::true_type {};
+
+template<typename T>
+inline constexpr bool is_columnar_batch_v = is_columnar_batch<T>::value;
+
+namespace batch::ops {
+
+// Filters rows of a columnar batch by a threshold comparison on column N,
+// the comparison reads only column N and runs with vectorized kernel
+template<size_t N, typename V>
+auto select_column_greater(V threshold) {
+    return [threshold](auto values) {
+        const auto& column = values.template column<N>();
+        std::vector<uint32_t> indices(column.size());
+        const auto count = batch::select_greater_indices(column.data(), column.size(), threshold, indices.data());
+        values.keep_rows(indices.data(), count);
+        return values;
+    };
+}
+
+template<size_t N, typename V>
+auto select_column_less(V threshold) {
+    return [threshold](auto values) {
+        const auto& column = values.template column<N>();
+        std::vector<uint32_t> indices(column.size());
+        const auto count = batch::select_less_indices(column.data(), column.size(), threshold, indices.data());
+        values.keep_rows(indices.data(), count);
+        return values;
+    };
+}
+
+} // namespace batch::ops
+
+} // namespace tiny_rx
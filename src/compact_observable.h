@@ -0,0 +1,247 @@
+#pragma once
+
+#include "guid.h"
+#include "iexecutor.h"
+#include "iobservable.h"
+#include "log.h"
+#include "subscription.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace tiny_rx {
+
+// Observable with a small memory footprint, for large numbers of rarely changing
+// sources (e.g. one per UI property). Up to kInlineSubscribers subscribers are stored
+// inline, without allocations (besides one validity flag shared by all subscriptions).
+// A subscriber keeps only its on_next() function, end / error handlers and
+// the executor are stored out of line when set, along with on_next() for subscribers
+// with an executor (tasks share it instead of copying). No operators: use
+// Observable<T...> to build chains
+template<typename ...T>
+class CompactObservable : public IObservable {
+public:
+    static constexpr size_t kInlineSubscribers = 2;
+
+    CompactObservable() = default;
+
+    ~CompactObservable() override {
+        if (valid_)
+            *valid_ = false;
+    }
+
+    CompactObservable(const CompactObservable&) = delete;
+    CompactObservable(CompactObservable&&) = delete;
+    CompactObservable& operator=(const CompactObservable&) = delete;
+    CompactObservable& operator=(CompactObservable&&) = delete;
+
+    // Executor for the next subscriber
+    CompactObservable& subscribe_on(std::shared_ptr<IExecutor> executor) {
+        pending_executor_ = std::move(executor);
+        return *this;
+    }
+
+    template<typename F, std::enable_if_t<std::is_object_v<F>, bool> = true>
+    Subscription subscribe(std::shared_ptr<F> object) {
+        return subscribe(
+            [object](T... args) { object->on_next(std::move(args)...); },
+            [object]() { object->on_end(); },
+            [object](std::string descr) { object->on_error(std::move(descr)); }
+        );
+    }
+
+    template<typename ...F>
+    Subscription subscribe(F&&... args) {
+        constexpr std::size_t size = sizeof...(F);
+        auto params = std::tuple<F...>(std::forward<F>(args)...);
+
+        auto& entry = emplace_back();
+        // 0 marks removed entries
+        if (++last_id_ == 0)
+            ++last_id_;
+        entry.id = last_id_;
+        if (size > 1 || pending_executor_) {
+            entry.handlers = std::make_shared<Handlers>();
+            if constexpr (size > 1)
+                entry.handlers->on_end = std::move(std::get<1>(params));
+            if constexpr (size > 2)
+                entry.handlers->on_error = std::move(std::get<2>(params));
+            entry.handlers->executor = std::move(pending_executor_);
+        }
+        // Executor tasks share the handlers, so on_next() lives there
+        if (entry.handlers && entry.handlers->executor)
+            entry.handlers->on_next = std::move(std::get<0>(params));
+        else
+            entry.on_next = std::move(std::get<0>(params));
+        pending_executor_.reset();
+
+        // One validity flag for all subscriptions: unsubscribing a removed
+        // subscriber finds no entry with its id
+        if (!valid_)
+            valid_ = std::make_shared<bool>(true);
+        return Subscription(this, Guid(entry.id), valid_);
+    }
+
+    void unsubscribe(const Guid& uuid) override {
+        for (size_t i = 0; i < size_; ++i) {
+            auto& entry = at(i);
+            if (entry.id != 0 && Guid(entry.id) == uuid) {
+                entry.id = 0;
+                has_removed_ = true;
+                break;
+            }
+        }
+        if (emitting_.load(std::memory_order_acquire) == 0)
+            remove_subscribers();
+    }
+
+    std::optional<Subscription> get_linked_subscription() override {
+        return std::nullopt;
+    }
+
+    [[nodiscard]] size_t subscribers_count() const override {
+        size_t res = 0;
+        for (size_t i = 0; i < size_; ++i) {
+            if (at(i).id != 0)
+                ++res;
+        }
+        return res;
+    }
+
+    void next(const T&... value) {
+        EmissionScope scope(*this);
+        for (size_t i = 0; i < size_; ++i) {
+            auto& entry = at(i);
+            if (entry.id == 0)
+                continue;
+            if (entry.handlers && entry.handlers->executor) {
+                entry.handlers->executor->add_task([handlers = entry.handlers, value...]() {
+                    handlers->on_next(value...);
+                });
+            } else {
+                entry.on_next(value...);
+            }
+        }
+    }
+
+    void end() {
+        EmissionScope scope(*this);
+        for (size_t i = 0; i < size_; ++i) {
+            auto& entry = at(i);
+            if (entry.id == 0 || !entry.handlers || !entry.handlers->on_end)
+                continue;
+            if (entry.handlers->executor)
+                entry.handlers->executor->add_task(entry.handlers->on_end);
+            else
+                entry.handlers->on_end();
+        }
+    }
+
+    void error(const std::string& descr) {
+        EmissionScope scope(*this);
+        for (size_t i = 0; i < size_; ++i) {
+            auto& entry = at(i);
+            if (entry.id == 0 || !entry.handlers || !entry.handlers->on_error)
+                continue;
+            if (entry.handlers->executor)
+                entry.handlers->executor->add_task(std::bind(entry.handlers->on_error, descr));
+            else
+                entry.handlers->on_error(descr);
+        }
+    }
+
+private:
+    struct Handlers {
+        std::function<void()> on_end;
+        std::function<void(std::string)> on_error;
+        std::shared_ptr<IExecutor> executor;
+        // Subscribers with an executor only
+        std::function<void(const T&...)> on_next;
+    };
+
+    struct Entry {
+        // Subscribers without an executor only
+        std::function<void(const T&...)> on_next;
+        std::shared_ptr<Handlers> handlers;
+        uint32_t id = 0; // 0 - removed
+    };
+
+    class EmissionScope {
+    public:
+        explicit EmissionScope(CompactObservable& observable)
+            : observable_{ observable } {
+            observable_.emitting_.fetch_add(1, std::memory_order_acq_rel);
+        }
+
+        ~EmissionScope() {
+            if (observable_.emitting_.fetch_sub(1, std::memory_order_acq_rel) == 1 && observable_.has_removed_)
+                observable_.remove_subscribers();
+        }
+
+        EmissionScope(const EmissionScope&) = delete;
+        EmissionScope& operator=(const EmissionScope&) = delete;
+
+    private:
+        CompactObservable& observable_;
+    };
+
+    Entry& at(size_t i) {
+        return i < kInlineSubscribers ? inline_[i] : overflow_[i - kInlineSubscribers];
+    }
+
+    const Entry& at(size_t i) const {
+        return i < kInlineSubscribers ? inline_[i] : overflow_[i - kInlineSubscribers];
+    }
+
+    Entry& emplace_back() {
+        if (size_ >= kInlineSubscribers)
+            overflow_.emplace_back();
+        return at(size_++);
+    }
+
+    // Keeps the subscription order
+    void remove_subscribers() {
+        if (!has_removed_)
+            return;
+        has_removed_ = false;
+
+        size_t kept = 0;
+        for (size_t i = 0; i < size_; ++i) {
+            auto& entry = at(i);
+            if (entry.id == 0)
+                continue;
+            if (kept != i)
+                at(kept) = std::move(entry);
+            ++kept;
+        }
+        for (size_t i = kept; i < std::min<size_t>(size_, kInlineSubscribers); ++i)
+            inline_[i] = Entry{};
+        if (kept > kInlineSubscribers)
+            overflow_.resize(kept - kInlineSubscribers);
+        else
+            overflow_.clear();
+        size_ = static_cast<uint32_t>(kept);
+    }
+
+    Entry inline_[kInlineSubscribers];
+    std::vector<Entry> overflow_;
+    std::shared_ptr<IExecutor> pending_executor_;
+    std::shared_ptr<bool> valid_;
+    uint32_t size_ = 0;
+    uint32_t last_id_ = 0;
+    std::atomic<uint32_t> emitting_{ 0 };
+    bool has_removed_ = false;
+#ifdef _DEBUG
+    const Guid uuid_; // For debug purposes
+#endif
+};
+
+} // namespace tiny_rx
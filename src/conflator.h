@@ -0,0 +1,116 @@
+#pragma once
+
+#include "iexecutor.h"
+#include "log.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace tiny_rx {
+
+// Key of conflated values: values with equal keys overwrite each other.
+// Values with equal hashes are compared, so colliding keys are kept apart
+template<typename ...T>
+struct ConflationKey {
+    std::function<size_t(const T&...)> hash;
+    // Whether the pending value has the same key as the new one
+    std::function<bool(const std::tuple<T...>&, const T&...)> equal;
+
+    explicit operator bool() const {
+        return static_cast<bool>(hash);
+    }
+};
+
+// Latest-value delivery for a subscriber on an executor: keeps at most one pending
+// value (or one per key) and overwrites it when a newer value arrives. Only one task
+// is queued to the executor at a time, it delivers all pending values
+// (keys in the order they were first updated)
+template<typename ...T>
+class Conflator : public std::enable_shared_from_this<Conflator<T...>> {
+public:
+    Conflator(std::function<void(const T&...)> func, ConflationKey<T...> key)
+        : func_{ std::move(func) }
+        , key_{ std::move(key) } {
+    }
+
+    Conflator(const Conflator&) = delete;
+    Conflator(Conflator&&) = delete;
+    Conflator& operator=(const Conflator&) = delete;
+    Conflator& operator=(Conflator&&) = delete;
+
+    void push(IExecutor& executor, const T&... values) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (auto* pending = find_pending(values...)) {
+                *pending = std::tie(values...);
+                conflated_.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                if (key_)
+                    index_.emplace(key_.hash(values...), pending_.size());
+                pending_.emplace_back(values...);
+            }
+            if (scheduled_)
+                return;
+            scheduled_ = true;
+        }
+        executor.add_task([self = this->shared_from_this()]() { self->drain(); });
+    }
+
+    // Number of values overwritten before delivery
+    [[nodiscard]] uint64_t conflated() const {
+        return conflated_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::tuple<T...>* find_pending(const T&... values) {
+        if (!key_)
+            return pending_.empty() ? nullptr : &pending_.front();
+        const auto [begin, end] = index_.equal_range(key_.hash(values...));
+        for (auto it = begin; it != end; ++it) {
+            if (key_.equal(pending_[it->second], values...))
+                return &pending_[it->second];
+        }
+        return nullptr;
+    }
+
+    void drain() {
+        std::vector<std::tuple<T...>> values;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            values.swap(pending_);
+            index_.clear();
+            scheduled_ = false;
+        }
+
+        for (const auto& v : values) {
+            try {
+                std::apply(func_, v);
+            } catch (const std::exception& e) {
+                log(utils::LogSeverity::Error, "Conflator exception in subscriber: ", e.what());
+            }
+        }
+
+        // Give the storage back to avoid reallocation on the next frame
+        values.clear();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_.empty())
+            pending_.swap(values);
+    }
+
+    std::function<void(const T&...)> func_;
+    ConflationKey<T...> key_;
+    std::mutex mutex_;
+    std::vector<std::tuple<T...>> pending_;
+    // Key hash -> index in pending_
+    std::unordered_multimap<size_t, size_t> index_;
+    bool scheduled_ = false;
+    std::atomic<uint64_t> conflated_{ 0 };
+};
+
+} // namespace tiny_rx
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+namespace tiny_rx {
+
+// Demand of subscribers that never called request(): no limit on emitted values
+inline constexpr uint64_t kUnboundedDemand = std::numeric_limits<uint64_t>::max();
+
+inline uint64_t add_demand(uint64_t a, uint64_t b) {
+    return a > kUnboundedDemand - b ? kUnboundedDemand : a + b;
+}
+
+inline uint64_t scale_demand(uint64_t n, uint64_t scale) {
+    return scale != 0 && n > kUnboundedDemand / scale ? kUnboundedDemand : n * scale;
+}
+
+} // namespace tiny_rx
@@ -0,0 +1,136 @@
+#include "distinct.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace tiny_rx {
+
+namespace {
+
+constexpr double kLn2 = 0.6931471805599453;
+
+} // namespace
+
+BloomFilter::BloomFilter(size_t capacity, double false_positive_rate)
+    : capacity_{ capacity } {
+    if (capacity == 0 || !(false_positive_rate > 0 && false_positive_rate < 1))
+        throw std::invalid_argument("BloomFilter: capacity should be positive, false_positive_rate should be in (0, 1)");
+
+    // Both generations are checked, each gets half of the rate
+    const auto rate = false_positive_rate / 2;
+    const auto bits = std::ceil(-static_cast<double>(capacity) * std::log(rate) / (kLn2 * kLn2));
+    bits_count_ = std::max<size_t>(64, static_cast<size_t>(bits));
+    hashes_ = std::max<size_t>(1, static_cast<size_t>(std::round(static_cast<double>(bits_count_) / static_cast<double>(capacity) * kLn2)));
+    current_.assign((bits_count_ + 63) / 64, 0);
+    previous_.assign(current_.size(), 0);
+}
+
+bool BloomFilter::insert(uint64_t hash) {
+    if (contains(hash))
+        return false;
+
+    if (inserted_ == capacity_) {
+        std::swap(current_, previous_);
+        std::fill(current_.begin(), current_.end(), 0);
+        inserted_ = 0;
+    }
+    // Double hashing: bit i is h1 + i * h2
+    const auto h1 = hash;
+    const auto h2 = mix_hash(hash) | 1;
+    for (size_t i = 0; i < hashes_; ++i) {
+        const auto bit = (h1 + i * h2) % bits_count_;
+        current_[bit / 64] |= uint64_t{ 1 } << (bit % 64);
+    }
+    ++inserted_;
+    return true;
+}
+
+bool BloomFilter::contains(uint64_t hash) const {
+    return contains(current_, hash) || contains(previous_, hash);
+}
+
+bool BloomFilter::contains(const Bits& bits, uint64_t hash) const {
+    const auto h1 = hash;
+    const auto h2 = mix_hash(hash) | 1;
+    for (size_t i = 0; i < hashes_; ++i) {
+        const auto bit = (h1 + i * h2) % bits_count_;
+        if ((bits[bit / 64] & (uint64_t{ 1 } << (bit % 64))) == 0)
+            return false;
+    }
+    return true;
+}
+
+size_t BloomFilter::memory_bytes() const {
+    return (current_.size() + previous_.size()) * sizeof(uint64_t);
+}
+
+size_t BloomFilter::hashes() const {
+    return hashes_;
+}
+
+HyperLogLog::HyperLogLog(uint8_t precision)
+    : precision_{ precision } {
+    if (precision < 4 || precision > 18)
+        throw std::invalid_argument("HyperLogLog: precision should be in [4, 18]");
+    registers_.assign(size_t{ 1 } << precision, 0);
+}
+
+HyperLogLog HyperLogLog::for_error_rate(double error_rate) {
+    if (!(error_rate > 0))
+        throw std::invalid_argument("HyperLogLog: error_rate should be positive");
+    uint8_t precision = 4;
+    while (precision < 18 && 1.04 / std::sqrt(static_cast<double>(size_t{ 1 } << precision)) > error_rate)
+        ++precision;
+    return HyperLogLog(precision);
+}
+
+void HyperLogLog::add(uint64_t hash) {
+    const auto index = hash >> (64 - precision_);
+    // Leading zeros of the remaining bits + 1, the sentinel bit limits it
+    const auto rest = (hash << precision_) | (uint64_t{ 1 } << (precision_ - 1));
+    uint8_t rank = 1;
+    for (auto bit = uint64_t{ 1 } << 63; (rest & bit) == 0; bit >>= 1)
+        ++rank;
+    registers_[index] = std::max(registers_[index], rank);
+}
+
+void HyperLogLog::merge(const HyperLogLog& other) {
+    if (other.precision_ != precision_)
+        throw std::invalid_argument("HyperLogLog: merged sketches should have the same precision");
+    for (size_t i = 0; i < registers_.size(); ++i)
+        registers_[i] = std::max(registers_[i], other.registers_[i]);
+}
+
+uint64_t HyperLogLog::estimate() const {
+    const auto m = static_cast<double>(registers_.size());
+    double sum = 0;
+    size_t zeros = 0;
+    for (const auto value : registers_) {
+        sum += std::ldexp(1.0, -value);
+        zeros += value == 0 ? 1 : 0;
+    }
+
+    double alpha = 0.7213 / (1 + 1.079 / m);
+    if (precision_ == 4)
+        alpha = 0.673;
+    else if (precision_ == 5)
+        alpha = 0.697;
+    else if (precision_ == 6)
+        alpha = 0.709;
+    const auto raw = alpha * m * m / sum;
+    // Linear counting for small cardinalities
+    if (raw <= 2.5 * m && zeros != 0)
+        return static_cast<uint64_t>(std::llround(m * std::log(m / static_cast<double>(zeros))));
+    return static_cast<uint64_t>(std::llround(raw));
+}
+
+double HyperLogLog::error_rate() const {
+    return 1.04 / std::sqrt(static_cast<double>(registers_.size()));
+}
+
+size_t HyperLogLog::memory_bytes() const {
+    return registers_.size();
+}
+
+} // namespace tiny_rx
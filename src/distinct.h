@@ -0,0 +1,130 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace tiny_rx {
+
+// Finalizer of splitmix64: spreads std::hash values (often identity for integers)
+// over all 64 bits
+inline uint64_t mix_hash(uint64_t value) {
+    value += 0x9e3779b97f4a7c15ull;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
+
+struct DistinctParams {
+    // Keys remembered at most, the least recently seen are forgotten first
+    size_t max_keys = 65536;
+    // Keys are forgotten this time after they were emitted, 0 - never
+    std::chrono::nanoseconds ttl{ 0 };
+    // Time source for ttl, steady_clock if empty
+    std::function<std::chrono::nanoseconds()> now;
+};
+
+// Set of recently seen keys bounded by DistinctParams
+template<typename K>
+class LruSet {
+public:
+    using Time = std::chrono::nanoseconds;
+
+    explicit LruSet(size_t max_keys, Time ttl = Time{ 0 })
+        : max_keys_{ max_keys }
+        , ttl_{ ttl } {
+    }
+
+    // Returns true if the key is new: not seen before, forgotten or expired
+    bool insert(const K& key, Time now = Time{ 0 }) {
+        const auto item = index_.find(key);
+        if (item != index_.end()) {
+            auto entry = item->second;
+            entries_.splice(entries_.begin(), entries_, entry);
+            if (ttl_.count() == 0 || now - entry->emitted < ttl_)
+                return false;
+            entry->emitted = now;
+            return true;
+        }
+
+        if (entries_.size() >= max_keys_) {
+            index_.erase(entries_.back().key);
+            entries_.pop_back();
+        }
+        entries_.push_front(Entry{ key, now });
+        index_.emplace(key, entries_.begin());
+        return true;
+    }
+
+    [[nodiscard]] size_t size() const {
+        return entries_.size();
+    }
+
+private:
+    struct Entry {
+        K key;
+        Time emitted;
+    };
+
+    size_t max_keys_;
+    Time ttl_;
+    // Most recently seen first
+    std::list<Entry> entries_;
+    std::unordered_map<K, typename std::list<Entry>::iterator> index_;
+};
+
+// Approximate set of hashes with a bounded false positive rate: two Bloom filter
+// generations of `capacity` keys each, when the current one is full the previous one
+// is dropped. So memory is fixed, keys are remembered for at least `capacity`
+// insertions and the false positive rate doesn't grow with the stream length
+class BloomFilter {
+public:
+    // Sized for `capacity` keys per generation with the false positive rate
+    BloomFilter(size_t capacity, double false_positive_rate);
+
+    // Returns true if the hash is new (false if it was probably seen)
+    bool insert(uint64_t hash);
+    [[nodiscard]] bool contains(uint64_t hash) const;
+
+    [[nodiscard]] size_t memory_bytes() const;
+    [[nodiscard]] size_t hashes() const;
+
+private:
+    using Bits = std::vector<uint64_t>;
+
+    [[nodiscard]] bool contains(const Bits& bits, uint64_t hash) const;
+
+    size_t capacity_;
+    size_t bits_count_;
+    size_t hashes_;
+    Bits current_;
+    Bits previous_;
+    size_t inserted_ = 0;
+};
+
+// Cardinality estimate (HyperLogLog) with 2^precision one byte registers,
+// standard error 1.04 / sqrt(2^precision). Mergeable with sketches of the same precision
+class HyperLogLog {
+public:
+    // precision in [4, 18]
+    explicit HyperLogLog(uint8_t precision = 14);
+    // Smallest precision with the standard error within the rate
+    static HyperLogLog for_error_rate(double error_rate);
+
+    void add(uint64_t hash);
+    // Throws std::invalid_argument if the precision differs
+    void merge(const HyperLogLog& other);
+
+    [[nodiscard]] uint64_t estimate() const;
+    [[nodiscard]] double error_rate() const;
+    [[nodiscard]] size_t memory_bytes() const;
+
+private:
+    uint8_t precision_;
+    std::vector<uint8_t> registers_;
+};
+
+} // namespace tiny_rx
@@ -4,7 +4,8 @@ namespace tiny_rx {
 
 enum class ExecutionPolicy {
     NoExecutor,
-    Executor
+    Executor,
+    KeyedExecutor
 };
 
 } // namespace tiny_rx
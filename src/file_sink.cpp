@@ -0,0 +1,42 @@
+#include "file_sink.h"
+
+#include "log.h"
+
+namespace tiny_rx {
+
+FileSink::FileSink(const std::string& path, FileSinkParams params)
+    : writer_{ path, params.writer }
+    , params_{ std::move(params) } {
+}
+
+void FileSink::on_next(std::string_view value) {
+    writer_.write(value.data(), value.size());
+    if (!params_.delimiter.empty())
+        writer_.write(params_.delimiter.data(), params_.delimiter.size());
+}
+
+void FileSink::on_end() {
+    if (params_.sync_on_end) {
+        writer_.sync();
+    } else {
+        writer_.flush();
+    }
+}
+
+void FileSink::on_error(const std::string& descr) {
+    log(utils::LogSeverity::Error, "FileSink: stream error: ", descr);
+}
+
+void FileSink::write(const void* data, size_t size) {
+    writer_.write(data, size);
+}
+
+void FileSink::flush() {
+    writer_.flush();
+}
+
+const AsyncFileWriterStats& FileSink::stats() const {
+    return writer_.stats();
+}
+
+} // namespace tiny_rx
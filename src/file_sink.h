@@ -0,0 +1,40 @@
+#pragma once
+
+#include "async_file_writer.h"
+
+#include <string>
+#include <string_view>
+
+namespace tiny_rx {
+
+struct FileSinkParams {
+    AsyncFileWriterParams writer;
+    // Appended after every value, e.g. "\n" for text logs
+    std::string delimiter;
+    // fsync() when the stream ends
+    bool sync_on_end = true;
+};
+
+// Subscriber object appending values to a file, e.g.
+// auto subscription = source.subscribe(std::make_shared<FileSink>("out.log"));
+// Values are collected into large blocks written by a dedicated I/O thread.
+// When the disk can't keep up, on_next() blocks the emitting thread
+class FileSink {
+public:
+    explicit FileSink(const std::string& path, FileSinkParams params = {});
+
+    void on_next(std::string_view value);
+    void on_end();
+    void on_error(const std::string& descr);
+
+    void write(const void* data, size_t size);
+    void flush();
+
+    [[nodiscard]] const AsyncFileWriterStats& stats() const;
+
+private:
+    AsyncFileWriter writer_;
+    FileSinkParams params_;
+};
+
+} // namespace tiny_rx
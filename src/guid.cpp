@@ -1,5 +1,6 @@
 #include "guid.h"
 
+#include <cstring>
 #include <random>
 #include <stdexcept>
 
@@ -23,6 +24,10 @@ Guid::Guid() {
     }
 }
 
+Guid::Guid(uint64_t id) {
+    std::memcpy(data_.data(), &id, sizeof(id));
+}
+
 std::string Guid::to_string() const {
     static constexpr bool kDash[] = { 0, 0, 0, 0, 1, 0, 1, 0, 1, 0, 1, 0, 0, 0, 0, 0 };
 
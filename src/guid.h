@@ -9,6 +9,8 @@ namespace tiny_rx {
 class Guid {
 public:
     Guid();
+    // Not random: made of a sequential id (used where storing a whole Guid is too costly)
+    explicit Guid(uint64_t id);
     [[nodiscard]] std::string to_string() const;
     bool operator==(const Guid& other) const;
 
@@ -8,6 +8,9 @@ class IExecutor {
 public:
     virtual ~IExecutor() = default;
     virtual void add_task(std::function<void()> f) = 0;
+    // Tasks run one at a time in the order they were added. An observable then passes
+    // a value to all its subscribers on the executor as one task
+    [[nodiscard]] virtual bool is_serial() const { return false; }
 };
 
 } // namespace tiny_rx
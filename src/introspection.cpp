@@ -0,0 +1,186 @@
+#include "introspection.h"
+
+#include <algorithm>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+namespace tiny_rx::introspection {
+
+namespace {
+
+struct Entry {
+    std::shared_ptr<NodeCounters> counters;
+    std::function<void(NodeInfo&)> describe;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::unordered_map<uint64_t, Entry> nodes;
+    uint64_t next_id = 1;
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+// For JSON and DOT strings: control characters are written as \uXXXX
+std::string escape(const std::string& str) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    std::string res;
+    res.reserve(str.size());
+    for (const char c : str) {
+        const auto code = static_cast<unsigned char>(c);
+        if (code < 0x20) {
+            res += "\\u00";
+            res += kHex[code >> 4];
+            res += kHex[code & 0xf];
+            continue;
+        }
+        if (c == '"' || c == '\\')
+            res += '\\';
+        res += c;
+    }
+    return res;
+}
+
+std::string address(const void* ptr) {
+    std::ostringstream out;
+    out << ptr;
+    return out.str();
+}
+
+bool is_leaking(const NodeInfo& node) {
+    return node.upstream != 0 && node.subscribers.empty();
+}
+
+} // namespace
+
+void enable(bool on) {
+    detail::enabled.store(on);
+}
+
+std::shared_ptr<NodeCounters> register_node(std::function<void(NodeInfo&)> describe) {
+    if (!enabled())
+        return nullptr;
+
+    auto counters = std::make_shared<NodeCounters>();
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    counters->id = r.next_id++;
+    r.nodes.emplace(counters->id, Entry{ counters, std::move(describe) });
+    return counters;
+}
+
+void unregister_node(uint64_t id) {
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.nodes.erase(id);
+}
+
+void set_source(NodeCounters& node, std::string kind, uint64_t upstream) {
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    node.kind = std::move(kind);
+    node.upstream = upstream;
+}
+
+std::vector<NodeInfo> snapshot() {
+    std::vector<NodeInfo> res;
+    auto& r = registry();
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        res.reserve(r.nodes.size());
+        for (const auto& [id, entry] : r.nodes) {
+            NodeInfo info;
+            info.id = id;
+            info.kind = entry.counters->kind;
+            info.upstream = entry.counters->upstream;
+            info.events_in = entry.counters->events_in.load(std::memory_order_relaxed);
+            info.events_out = entry.counters->events_out.load(std::memory_order_relaxed);
+            info.callback_ns = entry.counters->callback_ns.load(std::memory_order_relaxed);
+            info.allocations = entry.counters->allocations.load(std::memory_order_relaxed);
+            entry.describe(info);
+            res.push_back(std::move(info));
+        }
+    }
+    std::sort(res.begin(), res.end(), [](const NodeInfo& lhs, const NodeInfo& rhs) { return lhs.id < rhs.id; });
+    return res;
+}
+
+size_t nodes_count() {
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    return r.nodes.size();
+}
+
+void write_dot(std::ostream& out) {
+    const auto nodes = snapshot();
+    out << "digraph tiny_rx {\n";
+    out << "    node [shape=box, fontname=\"monospace\"];\n";
+    for (const auto& node : nodes) {
+        out << "    n" << node.id << " [label=\"" << escape(node.kind) << " #" << node.id
+            << "\\nin " << node.events_in << ", out " << node.events_out;
+        if (node.events_in != 0)
+            out << "\\ncallback " << node.callback_ns / 1000 << " us";
+        if (node.allocations != 0)
+            out << "\\nallocations " << node.allocations;
+        out << "\"";
+        if (is_leaking(node))
+            out << ", color=red, style=dashed";
+        out << "];\n";
+
+        for (size_t i = 0; i < node.subscribers.size(); ++i) {
+            const auto& subscriber = node.subscribers[i];
+            std::string target = "n" + std::to_string(subscriber.target);
+            if (subscriber.target == 0) {
+                target = "s" + std::to_string(node.id) + "_" + std::to_string(i);
+                out << "    " << target << " [label=\"" << escape(subscriber.name) << "\", shape=ellipse];\n";
+            }
+            out << "    n" << node.id << " -> " << target;
+            if (subscriber.executor_address)
+                out << " [label=\"" << subscriber.executor << " " << address(subscriber.executor_address) << "\"]";
+            out << ";\n";
+        }
+    }
+    out << "}\n";
+}
+
+void write_json(std::ostream& out) {
+    const auto nodes = snapshot();
+    out << "{\"nodes\":[";
+    for (size_t n = 0; n < nodes.size(); ++n) {
+        const auto& node = nodes[n];
+        out << (n == 0 ? "\n" : ",\n");
+        out << "{\"id\":" << node.id
+            << ",\"kind\":\"" << escape(node.kind) << "\""
+            << ",\"upstream\":" << node.upstream
+            << ",\"events_in\":" << node.events_in
+            << ",\"events_out\":" << node.events_out
+            << ",\"callback_ns\":" << node.callback_ns
+            << ",\"allocations\":" << node.allocations
+            << ",\"leaking\":" << (is_leaking(node) ? "true" : "false")
+            << ",\"subscribers\":[";
+        for (size_t i = 0; i < node.subscribers.size(); ++i) {
+            const auto& subscriber = node.subscribers[i];
+            out << (i == 0 ? "" : ",")
+                << "{\"name\":\"" << escape(subscriber.name) << "\""
+                << ",\"executor\":\"" << escape(subscriber.executor) << "\""
+                << ",\"executor_address\":\"" << (subscriber.executor_address ? address(subscriber.executor_address) : "") << "\""
+                << ",\"target\":" << subscriber.target << "}";
+        }
+        out << "]}";
+    }
+    out << "\n]}\n";
+}
+
+std::function<void()> counted(std::shared_ptr<NodeCounters> node, std::function<void()> task) {
+    if (!node)
+        return task;
+    return [node = std::move(node), task = std::move(task)]() {
+        invoke_counted(node.get(), task);
+    };
+}
+
+} // namespace tiny_rx::introspection
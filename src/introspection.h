@@ -0,0 +1,110 @@
+#pragma once
+
+#include "allocation_tracker.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace tiny_rx::introspection {
+
+// Registry of live observables (pipeline nodes), opt-in: observables created while
+// enabled are registered and count their events. A node made by an operator (map,
+// filter, ...) is fed by a subscriber of the upstream node, which counts values
+// received by the operator and the time spent in its callback (including synchronous
+// downstream callbacks). Filter pass rate is events_out / events_in of the filter node.
+// Heap allocations made by the callback are counted as well when the allocation hooks
+// are linked (see allocation_tracker.h), allocations / events_in gives the per event rate
+
+struct NodeCounters {
+    uint64_t id = 0;
+    // Operator name ("observable" for sources) and the upstream node,
+    // set by set_source() under the registry lock
+    std::string kind = "observable";
+    uint64_t upstream = 0;
+    std::atomic<uint64_t> events_in{ 0 };
+    std::atomic<uint64_t> events_out{ 0 };
+    std::atomic<uint64_t> callback_ns{ 0 };
+    std::atomic<uint64_t> allocations{ 0 };
+};
+
+struct SubscriberInfo {
+    std::string name;
+    // "none", "executor" or "keyed executor"
+    std::string executor;
+    const void* executor_address = nullptr;
+    // Node fed by this subscriber (operator), 0 for final subscribers
+    uint64_t target = 0;
+};
+
+struct NodeInfo {
+    uint64_t id = 0;
+    std::string kind;
+    uint64_t upstream = 0;
+    uint64_t events_in = 0;
+    uint64_t events_out = 0;
+    uint64_t callback_ns = 0;
+    uint64_t allocations = 0;
+    std::vector<SubscriberInfo> subscribers;
+};
+
+namespace detail {
+inline std::atomic<bool> enabled{ false };
+} // namespace detail
+
+inline bool enabled() {
+    return detail::enabled.load(std::memory_order_relaxed);
+}
+
+void enable(bool on = true);
+
+// Returns nullptr if disabled. `describe` fills the subscribers of the node,
+// it's called with the registry locked, so the node should unregister before destruction
+std::shared_ptr<NodeCounters> register_node(std::function<void(NodeInfo&)> describe);
+void unregister_node(uint64_t id);
+// Sets the operator name and the upstream node of a registered node: snapshot()
+// may read them concurrently
+void set_source(NodeCounters& node, std::string kind, uint64_t upstream);
+
+// Nodes sorted by id. Should not run concurrently with subscribing / unsubscribing
+std::vector<NodeInfo> snapshot();
+[[nodiscard]] size_t nodes_count();
+
+// Graphviz DOT: operator nodes with counters, edges labelled with executors.
+// Intermediate nodes without subscribers (leaking) are highlighted
+void write_dot(std::ostream& out);
+void write_json(std::ostream& out);
+
+// Counts the call, its time and allocations for the node fed by a subscriber
+template<typename F>
+void invoke_counted(NodeCounters* node, F&& func) {
+    if (!node) {
+        func();
+        return;
+    }
+    node->events_in.fetch_add(1, std::memory_order_relaxed);
+    const auto started = std::chrono::steady_clock::now();
+    struct Timer {
+        NodeCounters* node;
+        std::chrono::steady_clock::time_point started;
+        alloc::AllocationMeter meter;
+        ~Timer() {
+            const auto elapsed = std::chrono::steady_clock::now() - started;
+            node->callback_ns.fetch_add(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()), std::memory_order_relaxed);
+            if (const auto allocations = meter.allocations(); allocations != 0)
+                node->allocations.fetch_add(allocations, std::memory_order_relaxed);
+        }
+    } timer{ node, started, {} };
+    func();
+}
+
+// Executor task counted for the node
+std::function<void()> counted(std::shared_ptr<NodeCounters> node, std::function<void()> task);
+
+} // namespace tiny_rx::introspection
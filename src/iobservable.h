@@ -2,10 +2,16 @@
 
 #include "guid.h"
 
+#include <cstdint>
+#include <memory>
 #include <optional>
 
 namespace tiny_rx {
 
+namespace introspection {
+struct NodeCounters;
+} // namespace introspection
+
 class Subscription;
 
 class IObservable {
@@ -14,6 +20,10 @@ public:
     virtual void unsubscribe(const Guid& uuid) = 0;
     virtual std::optional<Subscription> get_linked_subscription() = 0;
     [[nodiscard]] virtual size_t subscribers_count() const = 0;
+    // Adds n to the number of values the subscriber is ready to receive
+    virtual void request(const Guid& /*uuid*/, uint64_t /*n*/) {}
+    // The subscriber feeds the node (an operator's observable), see introspection.h
+    virtual void attach_node(const Guid& /*uuid*/, std::shared_ptr<introspection::NodeCounters> /*node*/) {}
 };
 
 } // namespace tiny_rx
@@ -0,0 +1,49 @@
+#include "keyed_executor.h"
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+
+namespace tiny_rx {
+
+KeyedExecutor::KeyedExecutor(std::shared_ptr<IExecutor> executor, size_t lanes_count) {
+    if (lanes_count == 0)
+        throw std::invalid_argument("KeyedExecutor requires at least one lane");
+
+    lanes_.reserve(lanes_count);
+    for (size_t i = 0; i < lanes_count; ++i) {
+        lanes_.emplace_back(std::make_shared<SerialExecutor>(executor));
+    }
+}
+
+void KeyedExecutor::add_task(size_t key_hash, std::function<void()> f) {
+    lanes_[lane_index(key_hash)]->add_task(std::move(f));
+}
+
+void KeyedExecutor::add_barrier_task(std::function<void()> f) {
+    auto remaining = std::make_shared<std::atomic<size_t>>(lanes_.size());
+    auto task = std::make_shared<std::function<void()>>(std::move(f));
+    for (auto& lane : lanes_) {
+        lane->add_task([remaining, task]() {
+            if (--*remaining == 0)
+                (*task)();
+        });
+    }
+}
+
+std::shared_ptr<SerialExecutor> KeyedExecutor::lane(size_t key_hash) const {
+    return lanes_[lane_index(key_hash)];
+}
+
+size_t KeyedExecutor::lanes_count() const {
+    return lanes_.size();
+}
+
+size_t KeyedExecutor::lane_index(size_t key_hash) const {
+    // std::hash is identity for integers on common implementations,
+    // so mix bits before taking the modulo to spread sequential keys
+    const auto mixed = static_cast<uint64_t>(key_hash) * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>((mixed >> 32) % lanes_.size());
+}
+
+} // namespace tiny_rx
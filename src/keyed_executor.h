@@ -0,0 +1,42 @@
+#pragma once
+
+#include "iexecutor.h"
+#include "serial_executor.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace tiny_rx {
+
+// Fixed set of serialized lanes on top of a shared executor (usually ThreadPoolExecutor).
+// Tasks with the same key hash go to the same lane and are executed in order,
+// tasks of different lanes run in parallel
+class KeyedExecutor {
+public:
+    KeyedExecutor(std::shared_ptr<IExecutor> executor, size_t lanes_count);
+    KeyedExecutor(const KeyedExecutor&) = delete;
+    KeyedExecutor(KeyedExecutor&&) = delete;
+    KeyedExecutor& operator=(const KeyedExecutor&) = delete;
+    KeyedExecutor& operator=(KeyedExecutor&&) = delete;
+
+    void add_task(size_t key_hash, std::function<void()> f);
+    // Executes f once every lane has finished the tasks added before this call
+    void add_barrier_task(std::function<void()> f);
+
+    [[nodiscard]] std::shared_ptr<SerialExecutor> lane(size_t key_hash) const;
+    [[nodiscard]] size_t lanes_count() const;
+
+    template<typename K>
+    [[nodiscard]] std::shared_ptr<SerialExecutor> lane_for(const K& key) const {
+        return lane(std::hash<K>{}(key));
+    }
+
+private:
+    [[nodiscard]] size_t lane_index(size_t key_hash) const;
+
+    std::vector<std::shared_ptr<SerialExecutor>> lanes_;
+};
+
+} // namespace tiny_rx
@@ -3,6 +3,8 @@
 #include "guid.h"
 
 #include <iostream>
+#include <string>
+#include <string_view>
 #include <vector>
 
 #ifdef _MSC_VER
@@ -64,9 +66,11 @@ inline std::string format_func_name(std::string func_name) {
     return func_name;
 }
 
+// Formats the function name only when tracing is on, so disabled tracing doesn't allocate
 template<typename ...T>
-void trace_call(std::string func_name, T... args) {
-    log(LogSeverity::Trace, format_func_name(func_name), args...);
+void trace_call(std::string_view func_name, const T&... args) {
+    if (LogSeverity::Trace >= LOG_SEVERITY)
+        log(LogSeverity::Trace, format_func_name(std::string(func_name)), args...);
 }
 
 } // namespace tiny_rx::utils
@@ -0,0 +1,280 @@
+#include "mapped_file_source.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tiny_rx {
+
+namespace {
+
+#ifndef _WIN32
+size_t page_size() {
+    static const auto size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+#endif
+
+} // namespace
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path) {
+    file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                        FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Unable to open file " + path);
+
+    LARGE_INTEGER file_size{};
+    GetFileSizeEx(file_, &file_size);
+    size_ = static_cast<size_t>(file_size.QuadPart);
+    if (size_ == 0)
+        return;
+
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_ == nullptr) {
+        CloseHandle(file_);
+        throw std::runtime_error("Unable to map file " + path);
+    }
+    data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (data_ == nullptr) {
+        CloseHandle(mapping_);
+        CloseHandle(file_);
+        throw std::runtime_error("Unable to map file " + path);
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (data_)
+        UnmapViewOfFile(data_);
+    if (mapping_)
+        CloseHandle(mapping_);
+    CloseHandle(file_);
+}
+
+void MappedFile::advise_sequential() const {
+}
+
+void MappedFile::advise_will_need(size_t, size_t) const {
+}
+
+void MappedFile::advise_dont_need(size_t, size_t) const {
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Unable to open file " + path);
+
+    struct stat file_stat {};
+    if (fstat(fd, &file_stat) != 0) {
+        close(fd);
+        throw std::runtime_error("Unable to get size of file " + path);
+    }
+    size_ = static_cast<size_t>(file_stat.st_size);
+
+    if (size_ != 0) {
+        void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Unable to map file " + path);
+        }
+        data_ = static_cast<const char*>(data);
+    }
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data_)
+        munmap(const_cast<char*>(data_), size_);
+}
+
+void MappedFile::advise_sequential() const {
+    if (data_)
+        madvise(const_cast<char*>(data_), size_, MADV_SEQUENTIAL);
+}
+
+void MappedFile::advise_will_need(size_t offset, size_t length) const {
+    // madvise() requires page aligned address
+    const auto begin = offset / page_size() * page_size();
+    const auto end = std::min(offset + length, size_);
+    if (data_ && begin < end)
+        madvise(const_cast<char*>(data_) + begin, end - begin, MADV_WILLNEED);
+}
+
+void MappedFile::advise_dont_need(size_t offset, size_t length) const {
+    // Only whole pages below offset + length are dropped. The mapping is private and
+    // read-only, so this releases the pages mapped into this process (its resident
+    // memory), not the page cache: they are read again from the cache if accessed
+    const auto begin = (offset + page_size() - 1) / page_size() * page_size();
+    const auto end = std::min(offset + length, size_) / page_size() * page_size();
+    if (data_ && begin < end)
+        madvise(const_cast<char*>(data_) + begin, end - begin, MADV_DONTNEED);
+}
+
+#endif
+
+const char* MappedFile::data() const {
+    return data_;
+}
+
+size_t MappedFile::size() const {
+    return size_;
+}
+
+MappedFileSource::MappedFileSource(const std::string& path, MappedFileSourceParams params)
+    : file_{ path }
+    , params_{ params } {
+    if (params_.framing == RecordFraming::FixedSize && params_.record_size == 0)
+        throw std::invalid_argument("MappedFileSource: record_size is required for fixed size records");
+    file_.advise_sequential();
+}
+
+bool MappedFileSource::next_record(std::string_view& record) {
+    const auto* data = file_.data();
+    const auto size = file_.size();
+    if (position_ >= size)
+        return false;
+
+    size_t begin = position_;
+    size_t length = 0;
+    size_t next_position = 0;
+
+    switch (params_.framing) {
+    case RecordFraming::FixedSize:
+        if (size - position_ < params_.record_size) {
+            position_ = size;
+            return false;
+        }
+        length = params_.record_size;
+        next_position = begin + length;
+        break;
+    case RecordFraming::LengthPrefixed: {
+        // A partial length is a truncated record too
+        if (size - position_ < sizeof(uint32_t))
+            throw std::runtime_error("MappedFileSource: truncated record");
+        uint8_t prefix[sizeof(uint32_t)];
+        std::memcpy(prefix, data + position_, sizeof(prefix));
+        length = static_cast<size_t>(prefix[0]) | static_cast<size_t>(prefix[1]) << 8 |
+                 static_cast<size_t>(prefix[2]) << 16 | static_cast<size_t>(prefix[3]) << 24;
+        begin += sizeof(uint32_t);
+        if (size - begin < length)
+            throw std::runtime_error("MappedFileSource: truncated record");
+        next_position = begin + length;
+        break;
+    }
+    case RecordFraming::NewlineDelimited: {
+        const auto* end = static_cast<const char*>(std::memchr(data + begin, '\n', size - begin));
+        length = end ? static_cast<size_t>(end - (data + begin)) : size - begin;
+        next_position = begin + length + (end ? 1 : 0);
+        break;
+    }
+    }
+
+    advise(next_position);
+    record = std::string_view(data + begin, length);
+    position_ = next_position;
+    return true;
+}
+
+std::function<std::optional<std::tuple<std::string_view>>()> MappedFileSource::records() {
+    return [this]() -> std::optional<std::tuple<std::string_view>> {
+        std::string_view record;
+        if (!next_record(record))
+            return std::nullopt;
+        return std::make_tuple(record);
+    };
+}
+
+void MappedFileSource::advise(size_t next_position) {
+    if (params_.read_ahead == 0)
+        return;
+    // Request the next window when the reader passes the middle of the current one
+    if (advised_until_ > next_position + params_.read_ahead / 2)
+        return;
+
+    const auto from = std::max(advised_until_, next_position);
+    file_.advise_will_need(from, params_.read_ahead);
+    advised_until_ = from + params_.read_ahead;
+
+    if (params_.release_consumed && position_ > released_until_) {
+        file_.advise_dont_need(released_until_, position_ - released_until_);
+        released_until_ = position_;
+    }
+}
+
+bool MappedFileSource::read_record(std::string_view& record, std::string& error) {
+    // Only errors of the file are caught, not exceptions of the subscribers
+    try {
+        return next_record(record);
+    } catch (const std::runtime_error& e) {
+        error = e.what();
+        return false;
+    }
+}
+
+void MappedFileSource::emit(Observable<std::string_view>& observable) {
+    std::string_view record;
+    std::string error;
+    while (read_record(record, error)) {
+        observable.next(record);
+    }
+    if (error.empty())
+        observable.end();
+    else
+        observable.error(error);
+}
+
+void MappedFileSource::emit_batches(Observable<std::vector<std::string_view>>& observable, size_t batch_size) {
+    if (batch_size == 0)
+        throw std::invalid_argument("MappedFileSource: batch_size should be positive");
+
+    std::vector<std::string_view> records;
+    records.reserve(batch_size);
+    std::string_view record;
+    std::string error;
+    while (read_record(record, error)) {
+        records.push_back(record);
+        if (records.size() >= batch_size) {
+            observable.next(records);
+            records.clear();
+        }
+    }
+    // Records before a truncated one are valid
+    if (!records.empty())
+        observable.next(records);
+    if (error.empty())
+        observable.end();
+    else
+        observable.error(error);
+}
+
+void MappedFileSource::rewind() {
+    position_ = 0;
+    advised_until_ = 0;
+    released_until_ = 0;
+}
+
+size_t MappedFileSource::size() const {
+    return file_.size();
+}
+
+size_t MappedFileSource::position() const {
+    return position_;
+}
+
+} // namespace tiny_rx
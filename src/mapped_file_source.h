@@ -0,0 +1,91 @@
+#pragma once
+
+#include "observable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+namespace tiny_rx {
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile(MappedFile&&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&&) = delete;
+
+    [[nodiscard]] const char* data() const;
+    [[nodiscard]] size_t size() const;
+
+    // Read-ahead hints, no-op on platforms without madvise()
+    void advise_sequential() const;
+    void advise_will_need(size_t offset, size_t length) const;
+    void advise_dont_need(size_t offset, size_t length) const;
+
+private:
+    const char* data_{ nullptr };
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_{ nullptr };
+    void* mapping_{ nullptr };
+#endif
+};
+
+enum class RecordFraming {
+    FixedSize,       // records of record_size bytes, incomplete tail is dropped
+    LengthPrefixed,  // uint32 little-endian length followed by the record bytes
+    NewlineDelimited // records separated by '\n', the delimiter is not included
+};
+
+struct MappedFileSourceParams {
+    RecordFraming framing = RecordFraming::NewlineDelimited;
+    size_t record_size = 0;                  // FixedSize framing only
+    size_t read_ahead = 16 * 1024 * 1024;    // bytes requested with MADV_WILLNEED ahead of the reader
+    bool release_consumed = false;           // unmap already emitted pages from the process (MADV_DONTNEED),
+                                             // the page cache keeps them
+};
+
+// Splits a memory mapped file into records and emits views into the mapping,
+// without copying. Views are valid while the source object is alive
+class MappedFileSource {
+public:
+    explicit MappedFileSource(const std::string& path, MappedFileSourceParams params = {});
+
+    // Emits every record as a separate value, then end(). A truncated record
+    // is reported with error() instead of end()
+    void emit(Observable<std::string_view>& observable);
+    // Emits records in batches of up to batch_size (positive) views, then end()
+    void emit_batches(Observable<std::vector<std::string_view>>& observable, size_t batch_size);
+
+    // Splits the next record, returns false at the end of the file.
+    // Throws std::runtime_error on a truncated length-prefixed record or length
+    bool next_record(std::string_view& record);
+    // Record generator for ColdSource<std::string_view> to read the file on demand
+    [[nodiscard]] std::function<std::optional<std::tuple<std::string_view>>()> records();
+    void rewind();
+
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] size_t position() const;
+
+private:
+    // next_record() reporting a truncated record in `error`
+    bool read_record(std::string_view& record, std::string& error);
+    void advise(size_t next_position);
+
+    MappedFile file_;
+    MappedFileSourceParams params_;
+    size_t position_ = 0;
+    size_t advised_until_ = 0;
+    size_t released_until_ = 0;
+};
+
+} // namespace tiny_rx
@@ -0,0 +1,22 @@
+#include "memory_resource.h"
+
+namespace tiny_rx {
+
+namespace {
+thread_local std::pmr::memory_resource* thread_resource = nullptr;
+} // namespace
+
+std::pmr::memory_resource* current_memory_resource() {
+    return thread_resource ? thread_resource : std::pmr::get_default_resource();
+}
+
+ScopedMemoryResource::ScopedMemoryResource(std::pmr::memory_resource* resource)
+    : previous_{ thread_resource } {
+    thread_resource = resource;
+}
+
+ScopedMemoryResource::~ScopedMemoryResource() {
+    thread_resource = previous_;
+}
+
+} // namespace tiny_rx
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <memory_resource>
+
+namespace tiny_rx {
+
+// Memory resource used by observables created on this thread: subscriber and
+// subscription entries, operator nodes (intermediate observables and their state)
+// and subscription flags are allocated from it.
+// Returns std::pmr::get_default_resource() unless set by ScopedMemoryResource
+std::pmr::memory_resource* current_memory_resource();
+
+// Sets the memory resource for observables created on this thread while the object
+// exists, e.g. an arena for the bindings of a UI screen:
+//     std::pmr::unsynchronized_pool_resource pool;
+//     tiny_rx::ScopedMemoryResource scope(&pool);
+// The resource must outlive the observables and subscriptions created with it
+class ScopedMemoryResource {
+public:
+    explicit ScopedMemoryResource(std::pmr::memory_resource* resource);
+    ~ScopedMemoryResource();
+    ScopedMemoryResource(const ScopedMemoryResource&) = delete;
+    ScopedMemoryResource(ScopedMemoryResource&&) = delete;
+    ScopedMemoryResource& operator=(const ScopedMemoryResource&) = delete;
+    ScopedMemoryResource& operator=(ScopedMemoryResource&&) = delete;
+
+private:
+    std::pmr::memory_resource* previous_;
+};
+
+} // namespace tiny_rx
@@ -1,43 +1,165 @@
 #pragma once
 
+#include "batch_kernels.h"
+#include "columnar_batch.h"
+#include "demand.h"
+#include "distinct.h"
 #include "execution_policy.h"
 #include "guid.h"
 #include "iexecutor.h"
+#include "introspection.h"
 #include "iobservable.h"
+#include "keyed_executor.h"
+#include "log.h"
+#include "memory_resource.h"
+#include "reorder_buffer.h"
+#include "serialized_drain.h"
+#include "sketch.h"
+#include "sliding_window.h"
 #include "subscriber.h"
 #include "subscription.h"
+#include "tracer.h"
+#include "window_join.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <list>
 #include <memory>
+#include <memory_resource>
+#include <mutex>
 #include <optional>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace tiny_rx {
 
+namespace detail {
+inline std::atomic<size_t> live_observables{ 0 };
+} // namespace detail
+
+// Number of existing observables, including intermediate ones made by operators
+// (to check that operator chains are freed after unsubscribing)
+inline size_t live_observables() {
+    return detail::live_observables.load();
+}
+
+template<typename ...T>
+class ConnectableObservable;
+
 template<typename ...T>
 class Observable : public IObservable, public std::enable_shared_from_this<IObservable> {
 public:
-    Observable() {
+    Observable()
+        : Observable(current_memory_resource()) {
+    }
+
+    // Subscriber entries, subscriptions and operator nodes are allocated from `resource`,
+    // which must outlive the observable and its subscriptions
+    explicit Observable(std::pmr::memory_resource* resource)
+        : resource_{ resource }
+        , subscribers_{ resource }
+        , subscriptions_{ resource } {
         trace_call(__PRETTY_FUNCTION__, uuid_);
         set_default_params();
+        ++detail::live_observables;
+        if (introspection::enabled())
+            node_ = introspection::register_node([this](introspection::NodeInfo& info) { describe_node(info); });
     }
 
     // This usually is not what intended
     Observable(const Observable& other) = delete;
-    Observable(Observable&& other) = default;
     Observable& operator=(const Observable& other) = delete;
-    Observable& operator=(Observable&& other) = default;
+
+    // Meant for observables without subscribers yet: subscriptions refer to the observable
+    // by its address, so the ones taken before the move are invalidated. Their subscribers
+    // stay with the new observable until it's destroyed
+    Observable(Observable&& other)
+        : IObservable()
+        , std::enable_shared_from_this<IObservable>()
+        , executor_{ std::move(other.executor_) }
+        , keyed_executor_{ std::move(other.keyed_executor_) }
+        , key_hash_{ std::move(other.key_hash_) }
+        , execution_policy_{ other.execution_policy_ }
+        , resource_{ other.resource_ }
+        , subscribers_{ std::move(other.subscribers_) }
+        , subscriptions_{ std::move(other.subscriptions_) }
+        , executor_groups_{ std::move(other.executor_groups_) }
+        , executor_groups_dirty_{ other.executor_groups_dirty_ }
+        , removed_count_{ std::exchange(other.removed_count_, 0) }
+        , uuid_{ other.uuid_ }
+        , linked_subscription_{ std::move(other.linked_subscription_) }
+        , combined_subscriptions_{ std::move(other.combined_subscriptions_) }
+        , demand_mode_{ other.demand_mode_ }
+        , conflate_mode_{ other.conflate_mode_ }
+        , conflate_key_{ std::move(other.conflate_key_) }
+        , trace_name_{ other.trace_name_ }
+        , on_demand_{ std::move(other.on_demand_) }
+        , upstream_demand_{ std::move(other.upstream_demand_) } {
+        trace_call(__PRETTY_FUNCTION__, uuid_);
+        other.linked_subscription_.reset();
+        invalidate_subscriptions();
+        ++detail::live_observables;
+        if (introspection::enabled())
+            node_ = introspection::register_node([this](introspection::NodeInfo& info) { describe_node(info); });
+    }
+
+    // Same as the move constructor. Subscribers of this observable are dropped
+    // and their subscriptions invalidated, as on destruction
+    Observable& operator=(Observable&& other) {
+        trace_call(__PRETTY_FUNCTION__, uuid_);
+        if (this == &other)
+            return *this;
+
+        invalidate_subscriptions();
+        executor_ = std::move(other.executor_);
+        keyed_executor_ = std::move(other.keyed_executor_);
+        key_hash_ = std::move(other.key_hash_);
+        execution_policy_ = other.execution_policy_;
+        subscribers_ = std::move(other.subscribers_);
+        subscriptions_ = std::move(other.subscriptions_);
+        executor_groups_ = std::move(other.executor_groups_);
+        executor_groups_dirty_ = other.executor_groups_dirty_;
+        removed_count_ = std::exchange(other.removed_count_, 0);
+        linked_subscription_ = std::move(other.linked_subscription_);
+        other.linked_subscription_.reset();
+        combined_subscriptions_ = std::move(other.combined_subscriptions_);
+        demand_mode_ = other.demand_mode_;
+        conflate_mode_ = other.conflate_mode_;
+        conflate_key_ = std::move(other.conflate_key_);
+        trace_name_ = other.trace_name_;
+        on_demand_ = std::move(other.on_demand_);
+        upstream_demand_ = std::move(other.upstream_demand_);
+        invalidate_subscriptions();
+        return *this;
+    }
 
     void set_default_params() {
         executor_.reset();
+        keyed_executor_.reset();
+        key_hash_ = nullptr;
+        demand_mode_ = false;
+        conflate_mode_ = false;
+        conflate_key_ = {};
+        trace_name_ = nullptr;
         execution_policy_ = ExecutionPolicy::NoExecutor;
     }
 
     ~Observable() override {
         trace_call(__PRETTY_FUNCTION__, uuid_);
-        for (auto& s : subscriptions_) {
-            s.reset();
-        }
+        if (node_)
+            introspection::unregister_node(node_->id);
+        invalidate_subscriptions();
+        --detail::live_observables;
     }
 
     Observable& subscribe_on(std::shared_ptr<IExecutor> executor) {
@@ -46,6 +168,53 @@ public:
         return *this;
     }
 
+    // Keyed dispatch: values with the same key are processed in order on one lane
+    // of the keyed executor, values with different keys - in parallel
+    template<typename F>
+    Observable& subscribe_on(std::shared_ptr<KeyedExecutor> executor, F key_func) {
+        using K = std::decay_t<std::invoke_result_t<F, const T&...>>;
+        keyed_executor_ = std::move(executor);
+        key_hash_ = [key_func = std::move(key_func)](const T&... args) {
+            return std::hash<K>{}(key_func(args...));
+        };
+        execution_policy_ = ExecutionPolicy::KeyedExecutor;
+        return *this;
+    }
+
+    // Next subscriber starts in the demand mode with zero demand: it receives values
+    // only after Subscription::request(n). Producers check demand() before emitting
+    Observable& with_demand() {
+        demand_mode_ = true;
+        return *this;
+    }
+
+    // Next subscriber on an executor receives only the latest value: at most one value
+    // waits for the executor, newer values overwrite it (e.g. UI updated once per frame)
+    Observable& conflate() {
+        conflate_mode_ = true;
+        return *this;
+    }
+
+    // Same as conflate(), but the latest value is kept for every key
+    template<typename F>
+    Observable& conflate(F key_func) {
+        using K = std::decay_t<std::invoke_result_t<F, const T&...>>;
+        conflate_mode_ = true;
+        conflate_key_.hash = [key_func](const T&... args) {
+            return std::hash<K>{}(key_func(args...));
+        };
+        conflate_key_.equal = [key_func = std::move(key_func)](const std::tuple<T...>& pending, const T&... args) {
+            return std::apply(key_func, pending) == key_func(args...);
+        };
+        return *this;
+    }
+
+    // Name of the next subscriber's callback in traces (see tracer.h)
+    Observable& named(std::string_view name) {
+        trace_name_ = trace::intern(name);
+        return *this;
+    }
+
     template<typename F, std::enable_if_t<std::is_object_v<F>, bool> = true>
     Subscription subscribe(std::shared_ptr<F> object) {
         return subscribe(
@@ -58,12 +227,14 @@ public:
     template<typename ...F>
     Subscription subscribe(F&&... args) {
         constexpr std::size_t size = sizeof...(F);
+        const bool demand_mode = demand_mode_;
+        const auto demand_before = demand_mode ? demand() : kUnboundedDemand;
 
         subscribers_.emplace_back(Subscriber<T...>());
         auto& subscriber = subscribers_.back();
 
         auto params = std::tuple<F...>(args...);
-        subscriber.set_function(std::move(std::get<0>(params)));
+        subscriber.set_function(std::move(std::get<0>(params)), resource_);
         if constexpr (size > 1)
             subscriber.set_on_end(std::move(std::get<1>(params)));
         if constexpr (size > 2)
@@ -71,81 +242,303 @@ public:
 
         subscriber.set_execution_policy(execution_policy_);
         subscriber.set_executor(std::move(executor_));
+        subscriber.set_keyed_executor(std::move(keyed_executor_), std::move(key_hash_));
+        if (demand_mode)
+            subscriber.enable_demand();
+        if (conflate_mode_)
+            subscriber.enable_conflation(std::move(conflate_key_), resource_);
+        if (trace_name_)
+            subscriber.set_trace_name(trace_name_);
         set_default_params();
 
-        subscriptions_.emplace_back(this, subscriber.get_uuid());
-        return subscriptions_.back();
+        executor_groups_dirty_ = true;
+
+        subscriptions_.emplace_back(this, subscriber.get_uuid(), resource_);
+        auto subscription = subscriptions_.back();
+        if (demand_mode)
+            notify_demand(demand_before);
+        on_subscribers_changed();
+        return subscription;
     }
 
+    // An intermediate observable left without subscribers unsubscribes from its source,
+    // which frees it along with the operator state.
+    // Subscribers unsubscribed during an emission (e.g. from their own on_next())
+    // are removed when the emission ends
     void unsubscribe(const Guid& uuid) override {
-        for (auto i = subscribers_.begin(); i != subscribers_.end(); ++i) {
-            if (uuid == i->get_uuid()) {
-                subscribers_.erase(i);
+        for (auto& subscriber : subscribers_) {
+            if (uuid == subscriber.get_uuid() && !subscriber.is_removed()) {
+                subscriber.mark_removed();
+                ++removed_count_;
+                break;
+            }
+        }
+        if (emitting_.load(std::memory_order_acquire) == 0)
+            remove_subscribers();
+    }
+
+    void request(const Guid& uuid, uint64_t n) override {
+        const auto demand_before = demand();
+        for (auto& subscriber : subscribers_) {
+            if (uuid == subscriber.get_uuid()) {
+                subscriber.add_demand(n);
+                break;
+            }
+        }
+        notify_demand(demand_before);
+    }
+
+    void attach_node(const Guid& uuid, std::shared_ptr<introspection::NodeCounters> node) override {
+        for (auto& subscriber : subscribers_) {
+            if (uuid == subscriber.get_uuid()) {
+                introspection::set_source(*node, subscriber.get_trace_name(), node_ ? node_->id : 0);
+                subscriber.set_node(std::move(node));
+                executor_groups_dirty_ = true;
                 break;
             }
         }
     }
 
+    // Number of values all subscribers in the demand mode are ready to receive,
+    // kUnboundedDemand if there are no such subscribers.
+    // Values emitted beyond the demand are still delivered
+    [[nodiscard]] uint64_t demand() const {
+        uint64_t res = kUnboundedDemand;
+        for (const auto& subscriber : subscribers_) {
+            if (subscriber.has_demand() && !subscriber.is_removed())
+                res = std::min(res, subscriber.get_demand());
+        }
+        return res;
+    }
+
+    // Called with the increase of demand() when subscribers request more values
+    // (kUnboundedDemand when the last subscriber in the demand mode leaves)
+    void set_on_demand(std::function<void(uint64_t)> on_demand) {
+        on_demand_ = std::move(on_demand);
+    }
+
+    // Proxy observables pass the demand of their subscribers upstream, `scale` values
+    // of the upstream per value of the proxy
+    void forward_demand(Subscription upstream, uint64_t scale = 1) {
+        // The flag is shared rather than reached through `this`, which changes on move
+        upstream_demand_ = allocate<std::atomic<bool>>(resource_, false);
+        set_on_demand([upstream_demand = upstream_demand_, upstream, scale](uint64_t n) mutable {
+            upstream_demand->store(n != kUnboundedDemand);
+            upstream.request(scale_demand(n, scale));
+        });
+    }
+
+    // Requests more upstream values in place of consumed ones (e.g. dropped by filter)
+    void replenish_demand(uint64_t n) {
+        if (upstream_demand_ && upstream_demand_->load() && linked_subscription_)
+            linked_subscription_->request(n);
+    }
+
     std::optional<Subscription> get_linked_subscription() override {
         return std::optional<Subscription>{linked_subscription_};
     }
 
     size_t subscribers_count() const override {
-        return subscribers_.size();
+        return subscribers_.size() - removed_count_;
     }
 
     void detach() {
+        auto combined_subscriptions = std::move(combined_subscriptions_);
         if (linked_subscription_)
             linked_subscription_->unsubscribe();
+        for (auto& subscription : combined_subscriptions)
+            subscription.unsubscribe();
     }
 
+    // Subscribers sharing a serial executor (IExecutor::is_serial()) get one task
+    // per value, which calls them in the subscription order. Other tasks of the value
+    // on that executor (conflating subscribers) are queued before this task
     void next(const T&... value) {
+        EmissionScope scope(*this);
+        trace::EventScope trace_scope;
+        if (node_)
+            node_->events_out.fetch_add(1, std::memory_order_relaxed);
+        if (executor_groups_dirty_)
+            update_executor_groups();
+
         for (auto& subscriber : subscribers_) {
-            subscriber.on_next(value...);
+            if (subscriber.is_removed())
+                continue;
+            subscriber.consume_demand();
+            if (!subscriber.is_coalesced())
+                subscriber.on_next(value...);
+        }
+        for (const auto& group : executor_groups_) {
+            group.executor->add_task(trace::traced("executor group", [handlers = group.handlers, values = std::make_tuple(value...)]() {
+                for (const auto& handler : *handlers) {
+                    try {
+                        std::apply(handler, values);
+                    } catch (const std::exception& e) {
+                        log(utils::LogSeverity::Error, "Observable exception in subscriber: ", e.what());
+                    }
+                }
+            }));
         }
     }
 
     void end() {
+        EmissionScope scope(*this);
         for (auto& subscriber : subscribers_) {
-            subscriber.on_end();
+            if (!subscriber.is_removed())
+                subscriber.on_end();
         }
     }
 
     void error(const std::string& descr) {
+        EmissionScope scope(*this);
         for (auto& subscriber : subscribers_) {
-            subscriber.on_error(descr);
+            if (!subscriber.is_removed())
+                subscriber.on_error(descr);
         }
     }
 
     Observable& map(std::function<std::tuple<T...>(T...)> map_func) {
-        auto proxy_observable = std::make_shared<Observable<T...>>();
-        auto subscription = this->subscribe(
+        auto proxy_observable = allocate<Observable<T...>>(resource_, resource_);
+        auto subscription = this->trace_as("map").subscribe(
             [map_func = std::move(map_func), proxy_observable](const T&... args) {
-            auto res = map_func(args...);
-            std::apply(&Observable::next, std::tuple_cat(make_tuple(proxy_observable.get()), res));
+            std::apply([&proxy_observable](const T&... res) { proxy_observable->next(res...); }, map_func(args...));
+        });
+        proxy_observable->set_linked_info(subscription);
+        proxy_observable->forward_demand(subscription);
+        return *proxy_observable;
+    }
+
+    // Same as map(), but map_func is executed on the executor, up to max_in_flight values
+    // at once. Results are emitted in the source order: results completed early wait in
+    // a reorder buffer, next() blocks while max_in_flight values are pending, so the
+    // executor must run tasks on other threads than the producer (not RunLoopExecutor
+    // or VirtualTimeExecutor). Emission happens on the executor thread that completes
+    // the oldest pending value. An exception of map_func is emitted as error(), results
+    // after it are dropped
+    Observable& parallel_map(std::function<std::tuple<T...>(T...)> map_func, std::shared_ptr<IExecutor> executor,
+                             size_t max_in_flight, std::shared_ptr<ReorderStats> stats = nullptr) {
+        auto proxy_observable = allocate<Observable<T...>>(resource_, resource_);
+        auto buffer = allocate<ReorderBuffer>(resource_, max_in_flight, std::move(stats));
+        auto subscription = this->trace_as("parallel_map").subscribe(
+            [map_func = std::move(map_func), executor = std::move(executor), buffer, proxy_observable](const T&... args) {
+            const auto seq = buffer->acquire();
+            executor->add_task([map_func, buffer, proxy_observable, seq, args...]() {
+                try {
+                    auto res = map_func(args...);
+                    buffer->complete(seq, [proxy_observable, res = std::move(res)]() {
+                        std::apply([&proxy_observable](const T&... values) { proxy_observable->next(values...); }, res);
+                    });
+                } catch (const std::exception& e) {
+                    buffer->complete(seq, [proxy_observable, descr = std::string(e.what())]() {
+                        proxy_observable->error(descr);
+                    }, true);
+                } catch (...) {
+                    // The slot must be completed anyway, otherwise the buffer waits for it forever
+                    buffer->complete(seq, [proxy_observable]() {
+                        proxy_observable->error("parallel_map: unknown exception");
+                    }, true);
+                }
+            });
+        },
+        [buffer, proxy_observable]() {
+            buffer->complete(buffer->acquire(), [proxy_observable]() { proxy_observable->end(); }, true);
+        },
+        [buffer, proxy_observable](const std::string& descr) {
+            buffer->complete(buffer->acquire(), [proxy_observable, descr]() { proxy_observable->error(descr); }, true);
         });
         proxy_observable->set_linked_info(subscription);
+        proxy_observable->forward_demand(subscription);
         return *proxy_observable;
     }
 
     Observable& filter(std::function<bool(T...)> filter_func) {
-        auto proxy_observable = std::make_shared<Observable<T...>>();
-        auto subscription = this->subscribe(
+        auto proxy_observable = allocate<Observable<T...>>(resource_, resource_);
+        auto subscription = this->trace_as("filter").subscribe(
             [filter_func = std::move(filter_func), proxy_observable](const T&... args) {
             const auto filter_res = filter_func(args...);
             if (filter_res)
                 proxy_observable->next(args...);
+            else
+                proxy_observable->replenish_demand(1);
         });
         proxy_observable->set_linked_info(subscription);
+        proxy_observable->forward_demand(subscription);
         return *proxy_observable;
     }
     
+    // Drops values equal to the previous value
+    Observable& distinct_until_changed() {
+        auto proxy_observable = allocate<Observable<T...>>(resource_, resource_);
+        auto previous = allocate<std::optional<std::tuple<T...>>>(resource_);
+        auto subscription = this->trace_as("distinct_until_changed").subscribe(
+            [proxy_observable, previous](const T&... args) {
+            if (*previous && *previous == std::tie(args...)) {
+                proxy_observable->replenish_demand(1);
+                return;
+            }
+            previous->emplace(args...);
+            proxy_observable->next(args...);
+        });
+        proxy_observable->set_linked_info(subscription);
+        proxy_observable->forward_demand(subscription);
+        return *proxy_observable;
+    }
+
+    // Emits values with keys not seen before. Seen keys are kept in an LRU set bounded
+    // by params.max_keys (and optionally forgotten after params.ttl), so a key
+    // is emitted again after it's forgotten
+    template<typename F, typename K = std::decay_t<std::invoke_result_t<F, const T&...>>>
+    Observable& distinct(F key_func, DistinctParams params = {}) {
+        if (params.max_keys == 0)
+            throw std::invalid_argument("distinct: max_keys should be positive");
+        if (params.ttl.count() != 0 && !params.now)
+            params.now = []() { return std::chrono::steady_clock::now().time_since_epoch(); };
+
+        auto proxy_observable = allocate<Observable<T...>>(resource_, resource_);
+        auto seen = allocate<LruSet<K>>(resource_, params.max_keys, params.ttl);
+        auto subscription = this->trace_as("distinct").subscribe(
+            [proxy_observable, seen, key_func = std::move(key_func), now = std::move(params.now)](const T&... args) {
+            if (seen->insert(key_func(args...), now ? now() : std::chrono::nanoseconds{ 0 }))
+                proxy_observable->next(args...);
+            else
+                proxy_observable->replenish_demand(1);
+        });
+        proxy_observable->set_linked_info(subscription);
+        proxy_observable->forward_demand(subscription);
+        return *proxy_observable;
+    }
+
+    Observable& distinct(DistinctParams params = {}) {
+        static_assert(sizeof...(T) == 1, "distinct() without a key function requires a single value observable");
+        return distinct([](const T&... value) { return (value, ...); }, std::move(params));
+    }
+
+    // Approximate distinct in fixed memory: keys are hashed into a BloomFilter sized for
+    // `capacity` keys, a new key is dropped with probability up to false_positive_rate.
+    // Keys are remembered for at least `capacity` distinct keys
+    template<typename F>
+    Observable& approx_distinct(F key_func, size_t capacity, double false_positive_rate = 0.01) {
+        using K = std::decay_t<std::invoke_result_t<F, const T&...>>;
+        auto proxy_observable = allocate<Observable<T...>>(resource_, resource_);
+        auto filter = allocate<BloomFilter>(resource_, capacity, false_positive_rate);
+        auto subscription = this->trace_as("approx_distinct").subscribe(
+            [proxy_observable, filter, key_func = std::move(key_func)](const T&... args) {
+            if (filter->insert(mix_hash(std::hash<K>{}(key_func(args...)))))
+                proxy_observable->next(args...);
+            else
+                proxy_observable->replenish_demand(1);
+        });
+        proxy_observable->set_linked_info(subscription);
+        proxy_observable->forward_demand(subscription);
+        return *proxy_observable;
+    }
+
     using I = std::tuple_element_t<0, std::tuple<T...>>;
     Observable<I>& reduce(std::function<I(I, I)> reduce_func, I init_val) {
-        auto proxy_observable = std::make_shared<Observable<I>>();
-        auto result = std::make_shared<I>(init_val);
+        auto proxy_observable = allocate<Observable<I>>(resource_, resource_);
+        auto result = allocate<I>(resource_, init_val);
 
-        auto subscription = this->subscribe(
+        auto subscription = this->trace_as("reduce").subscribe(
             [reduce_func = std::move(reduce_func), result](T... args) {
             std::apply([reduce_func, result](auto&&... values) {((
                 *result = reduce_func(*result, values)
@@ -159,21 +552,841 @@ public:
         return *proxy_observable;
     }
 
+    // Emits the accumulator after every value: acc = scan_func(acc, values...),
+    // starting from init_val. reduce() for endless streams
+    template<typename A, typename F>
+    Observable<A>& scan(F scan_func, A init_val) {
+        auto proxy_observable = allocate<Observable<A>>(resource_, resource_);
+        auto result = allocate<A>(resource_, std::move(init_val));
+
+        auto subscription = this->trace_as("scan").subscribe(
+            [scan_func = std::move(scan_func), proxy_observable, result](const T&... args) {
+            *result = scan_func(std::move(*result), args...);
+            proxy_observable->next(*result);
+        },
+        [proxy_observable]() {
+            proxy_observable->end();
+        },
+        [proxy_observable](const std::string& descr) {
+            proxy_observable->error(descr);
+        });
+        proxy_observable->set_linked_info(subscription);
+        proxy_observable->forward_demand(subscription);
+        return *proxy_observable;
+    }
+
+    // Emits the aggregate of the last `count` values after every value, e.g.
+    //     source.sliding<window::Average>(1000000)
+    // Aggregations (window::Sum, Min, Max, Average) are updated in O(1) amortized time
+    template<template<typename> class Aggregation, typename V = I>
+    Observable<typename Aggregation<V>::Result>& sliding(size_t count) {
+        static_assert(sizeof...(T) == 1, "sliding() requires a single value observable");
+        if (count == 0)
+            throw std::invalid_argument("sliding: count should be positive");
+        return sliding_window<Aggregation<V>, V>(SlidingWindow<Aggregation<V>>(count), nullptr);
+    }
+
+    // Same as sliding(count), for values of the last `duration` (by arrival time).
+    // now() returns the time since the epoch of a clock, steady_clock if empty
+    template<template<typename> class Aggregation, typename V = I>
+    Observable<typename Aggregation<V>::Result>& sliding(std::chrono::nanoseconds duration,
+        std::function<std::chrono::nanoseconds()> now = {}) {
+        static_assert(sizeof...(T) == 1, "sliding() requires a single value observable");
+        if (duration.count() < 0)
+            throw std::invalid_argument("sliding: duration should not be negative");
+        if (!now)
+            now = []() { return std::chrono::steady_clock::now().time_since_epoch(); };
+        return sliding_window<Aggregation<V>, V>(SlidingWindow<Aggregation<V>>(duration), std::move(now));
+    }
+
+    // Adds values to a mergeable sketch (DDSketch, FixedHistogram), which may be updated
+    // from several threads at once (e.g. subscribed on a ThreadPoolExecutor). Emits the
+    // merged snapshot every `emit_every` values (0 - never) and on end(), snapshots
+    // may also be taken from the sketch directly at any time
+    template<typename S, typename V = I>
+    Observable<S>& sketch(std::shared_ptr<ShardedSketch<S>> sketch, size_t emit_every = 0) {
+        static_assert(sizeof...(T) == 1, "sketch() requires a single value observable");
+        // Snapshot, end (neither) or error
+        struct Event {
+            std::optional<S> snapshot;
+            std::optional<std::string> error;
+        };
+        auto proxy_observable = allocate<Observable<S>>(resource_, resource_);
+        auto added = allocate<std::atomic<uint64_t>>(resource_, 0);
+        auto drain = allocate<SerializedDrain<Event>>(resource_, [proxy_observable](Event& event) {
+            if (event.snapshot)
+                proxy_observable->next(*event.snapshot);
+            else if (event.error)
+                proxy_observable->error(*event.error);
+            else
+                proxy_observable->end();
+        });
+
+        auto subscription = this->trace_as("sketch").subscribe(
+            [sketch, emit_every, added, drain](const V& value) {
+            sketch->add(static_cast<double>(value));
+            if (emit_every != 0 && (added->fetch_add(1, std::memory_order_relaxed) + 1) % emit_every == 0)
+                drain->push(Event{ sketch->snapshot(), std::nullopt });
+        },
+        [sketch, drain]() {
+            drain->push(Event{ sketch->snapshot(), std::nullopt });
+            drain->push(Event{});
+        },
+        [drain](const std::string& descr) {
+            drain->push(Event{ std::nullopt, descr });
+        });
+        proxy_observable->set_linked_info(subscription);
+        return *proxy_observable;
+    }
+
+    // Approximate number of distinct values (HyperLogLog) in memory chosen by the
+    // error rate (16 KB for 1%), emitted every `emit_every` values (0 - never) and on end()
+    template<typename V = I>
+    Observable<uint64_t>& count_distinct(double error_rate = 0.01, size_t emit_every = 0) {
+        static_assert(sizeof...(T) == 1, "count_distinct() requires a single value observable");
+        auto proxy_observable = allocate<Observable<uint64_t>>(resource_, resource_);
+        auto sketch = allocate<HyperLogLog>(resource_, HyperLogLog::for_error_rate(error_rate));
+        auto added = allocate<size_t>(resource_, 0);
+
+        auto subscription = this->trace_as("count_distinct").subscribe(
+            [proxy_observable, sketch, added, emit_every](const V& value) {
+            sketch->add(mix_hash(std::hash<V>{}(value)));
+            if (emit_every != 0 && ++*added % emit_every == 0)
+                proxy_observable->next(sketch->estimate());
+        },
+        [proxy_observable, sketch]() {
+            proxy_observable->next(sketch->estimate());
+            proxy_observable->end();
+        },
+        [proxy_observable](const std::string& descr) {
+            proxy_observable->error(descr);
+        });
+        proxy_observable->set_linked_info(subscription);
+        return *proxy_observable;
+    }
+
+    // Splits the stream into sub-streams by key. A (key, sub-stream) pair is emitted
+    // the first time a key is seen, right before the value is passed to the sub-stream,
+    // so subscribing to the sub-stream in on_next() doesn't lose the first value
+    template<typename F, typename K = std::decay_t<std::invoke_result_t<F, const T&...>>>
+    Observable<K, std::shared_ptr<Observable<T...>>>& group_by(F key_func) {
+        using Group = Observable<T...>;
+        struct Groups {
+            std::mutex mutex;
+            std::unordered_map<K, std::shared_ptr<Group>> items;
+        };
+
+        auto proxy_observable = allocate<Observable<K, std::shared_ptr<Group>>>(resource_, resource_);
+        auto groups = allocate<Groups>(resource_);
+        auto for_each_group = [groups](auto func) {
+            std::vector<std::shared_ptr<Group>> items;
+            {
+                std::lock_guard<std::mutex> lock(groups->mutex);
+                for (auto& [key, group] : groups->items) {
+                    items.push_back(group);
+                }
+            }
+            for (auto& group : items) {
+                func(*group);
+            }
+        };
+
+        auto subscription = this->trace_as("group_by").subscribe(
+            [key_func = std::move(key_func), proxy_observable, groups, resource = resource_](const T&... args) {
+            K key = key_func(args...);
+            std::shared_ptr<Group> group;
+            bool created = false;
+            {
+                std::lock_guard<std::mutex> lock(groups->mutex);
+                auto& item = groups->items[key];
+                if (!item) {
+                    item = allocate<Group>(resource, resource);
+                    created = true;
+                }
+                group = item;
+            }
+            if (created)
+                proxy_observable->next(key, group);
+            group->next(args...);
+        },
+        [proxy_observable, for_each_group]() {
+            for_each_group([](Group& group) { group.end(); });
+            proxy_observable->end();
+        },
+        [proxy_observable, for_each_group](const std::string& descr) {
+            for_each_group([&descr](Group& group) { group.error(descr); });
+            proxy_observable->error(descr);
+        });
+        proxy_observable->set_linked_info(subscription);
+        return *proxy_observable;
+    }
+
+    // Collects values into batches of `count` values (e.g. to process them with batch kernels).
+    // Incomplete batch is emitted on end()
+    template<typename V = I>
+    Observable<std::vector<V>>& buffer(size_t count) {
+        static_assert(sizeof...(T) == 1, "buffer() requires a single value observable");
+        auto proxy_observable = allocate<Observable<std::vector<V>>>(resource_, resource_);
+        auto values = allocate<std::vector<V>>(resource_);
+        values->reserve(count);
+
+        auto subscription = this->trace_as("buffer").subscribe(
+            [proxy_observable, values, count](const V& value) {
+            values->push_back(value);
+            if (values->size() >= count) {
+                proxy_observable->next(std::exchange(*values, {}));
+                values->reserve(count);
+            }
+        },
+        [proxy_observable, values]() {
+            if (!values->empty())
+                proxy_observable->next(std::exchange(*values, {}));
+            proxy_observable->end();
+        },
+        [proxy_observable](const std::string& descr) {
+            proxy_observable->error(descr);
+        });
+        proxy_observable->set_linked_info(subscription);
+        proxy_observable->forward_demand(subscription, count);
+        return *proxy_observable;
+    }
+
+    // Collects multi-value events into columnar batches of `count` rows.
+    // Incomplete batch is emitted on end()
+    Observable<ColumnarBatch<T...>>& buffer_columnar(size_t count) {
+        auto proxy_observable = allocate<Observable<ColumnarBatch<T...>>>(resource_, resource_);
+        auto values = allocate<ColumnarBatch<T...>>(resource_);
+        values->reserve(count);
+
+        auto subscription = this->trace_as("buffer_columnar").subscribe(
+            [proxy_observable, values, count](const T&... args) {
+            values->push_back(args...);
+            if (values->size() >= count) {
+                proxy_observable->next(std::exchange(*values, {}));
+                values->reserve(count);
+            }
+        },
+        [proxy_observable, values]() {
+            if (!values->empty())
+                proxy_observable->next(std::exchange(*values, {}));
+            proxy_observable->end();
+        },
+        [proxy_observable](const std::string& descr) {
+            proxy_observable->error(descr);
+        });
+        proxy_observable->set_linked_info(subscription);
+        proxy_observable->forward_demand(subscription, count);
+        return *proxy_observable;
+    }
+
+    // reduce_batch() over column N of columnar batches, other columns are not read
+    template<size_t N, typename B = I, std::enable_if_t<is_columnar_batch_v<B>, bool> = true>
+    Observable<typename B::template ColumnType<N>>& reduce_column(batch::Reduction reduction) {
+        using V = typename B::template ColumnType<N>;
+        auto proxy_observable = allocate<Observable<V>>(resource_, resource_);
+        auto result = allocate<V>(resource_, batch::reduce(static_cast<const V*>(nullptr), 0, reduction));
+
+        auto subscription = this->trace_as("reduce_column").subscribe(
+            [reduction, result](const B& values) {
+            const auto& column = values.template column<N>();
+            const V partial[] = { *result, batch::reduce(column.data(), column.size(), reduction) };
+            *result = batch::reduce(partial, 2, reduction);
+        },
+        [proxy_observable, result]() {
+            proxy_observable->next(*result);
+            proxy_observable->end();
+        });
+        proxy_observable->set_linked_info(subscription);
+        return *proxy_observable;
+    }
+
+    // reduce() for observables of batches (std::vector of int, float or double),
+    // each batch is reduced with vectorized kernel. Result is emitted on end()
+    template<typename B = I, std::enable_if_t<batch::is_batch_v<B>, bool> = true>
+    Observable<typename B::value_type>& reduce_batch(batch::Reduction reduction) {
+        using V = typename B::value_type;
+        auto proxy_observable = allocate<Observable<V>>(resource_, resource_);
+        auto result = allocate<V>(resource_, batch::reduce(static_cast<const V*>(nullptr), 0, reduction));
+
+        auto subscription = this->trace_as("reduce_batch").subscribe(
+            [reduction, result](const B& values) {
+            const V partial[] = { *result, batch::reduce(values.data(), values.size(), reduction) };
+            *result = batch::reduce(partial, 2, reduction);
+        },
+        [proxy_observable, result]() {
+            proxy_observable->next(*result);
+            proxy_observable->end();
+        });
+        proxy_observable->set_linked_info(subscription);
+        return *proxy_observable;
+    }
+
+    // Values of this and `other` observable in arrival order, ends when both end.
+    // Sources may emit on different threads: emissions are serialized without locks,
+    // see SerializedDrain
+    Observable& merge(Observable<T...>& other) {
+        return combine<Observable<T...>>(other, "merge",
+            [active = 2](Observable<T...>& proxy, CombineEvent<T...>& event) mutable {
+            if (event.kind == NotificationKind::Error) {
+                proxy.error(event.descr);
+                return true;
+            }
+            if (event.kind == NotificationKind::End) {
+                if (--active != 0)
+                    return false;
+                proxy.end();
+                return true;
+            }
+            std::apply([&proxy](const T&... values) { proxy.next(values...); },
+                event.right ? *event.right_values : *event.left_values);
+            return false;
+        });
+    }
+
+    // Pairs the n-th value of this observable with the n-th value of `other`.
+    // Values waiting for a pair are buffered (unbounded), ends when a source ends
+    // and all of its values are paired
+    template<typename ...U>
+    Observable<T..., U...>& zip(Observable<U...>& other) {
+        struct Pending {
+            std::deque<std::tuple<T...>> left;
+            std::deque<std::tuple<U...>> right;
+            bool left_ended = false;
+            bool right_ended = false;
+        };
+        return combine<Observable<T..., U...>>(other, "zip",
+            [pending = Pending{}](Observable<T..., U...>& proxy, CombineEvent<U...>& event) mutable {
+            if (event.kind == NotificationKind::Error) {
+                proxy.error(event.descr);
+                return true;
+            }
+            if (event.kind == NotificationKind::End)
+                (event.right ? pending.right_ended : pending.left_ended) = true;
+            else if (event.right)
+                pending.right.push_back(std::move(*event.right_values));
+            else
+                pending.left.push_back(std::move(*event.left_values));
+
+            while (!pending.left.empty() && !pending.right.empty()) {
+                std::apply([&proxy](const auto&... values) { proxy.next(values...); },
+                    std::tuple_cat(std::move(pending.left.front()), std::move(pending.right.front())));
+                pending.left.pop_front();
+                pending.right.pop_front();
+            }
+            if ((pending.left_ended && pending.left.empty()) || (pending.right_ended && pending.right.empty())) {
+                proxy.end();
+                return true;
+            }
+            return false;
+        });
+    }
+
+    // Emits the latest values of both observables when either of them emits,
+    // once both have emitted. Ends when both end
+    template<typename ...U>
+    Observable<T..., U...>& combine_latest(Observable<U...>& other) {
+        struct Latest {
+            std::optional<std::tuple<T...>> left;
+            std::optional<std::tuple<U...>> right;
+            int active = 2;
+        };
+        return combine<Observable<T..., U...>>(other, "combine_latest",
+            [latest = Latest{}](Observable<T..., U...>& proxy, CombineEvent<U...>& event) mutable {
+            if (event.kind == NotificationKind::Error) {
+                proxy.error(event.descr);
+                return true;
+            }
+            if (event.kind == NotificationKind::End) {
+                if (--latest.active != 0)
+                    return false;
+                proxy.end();
+                return true;
+            }
+            if (event.right)
+                latest.right = std::move(event.right_values);
+            else
+                latest.left = std::move(event.left_values);
+            if (latest.left && latest.right) {
+                std::apply([&proxy](const auto&... values) { proxy.next(values...); },
+                    std::tuple_cat(*latest.left, *latest.right));
+            }
+            return false;
+        });
+    }
+
+    // Emits values of this observable with the latest values of `other`
+    // (values emitted before `other` emits are dropped). Ends when this observable ends
+    template<typename ...U>
+    Observable<T..., U...>& with_latest_from(Observable<U...>& other) {
+        return combine<Observable<T..., U...>>(other, "with_latest_from",
+            [latest = std::optional<std::tuple<U...>>{}](Observable<T..., U...>& proxy, CombineEvent<U...>& event) mutable {
+            if (event.kind == NotificationKind::Error) {
+                proxy.error(event.descr);
+                return true;
+            }
+            if (event.kind == NotificationKind::End) {
+                if (event.right)
+                    return false;
+                proxy.end();
+                return true;
+            }
+            if (event.right) {
+                latest = std::move(event.right_values);
+            } else if (latest) {
+                std::apply([&proxy](const auto&... values) { proxy.next(values...); },
+                    std::tuple_cat(std::move(*event.left_values), *latest));
+            }
+            return false;
+        });
+    }
+
+    // Windowed hash join: emits (left, right) for every value of this observable and value
+    // of `other` with equal keys (key_left(left) == key_right(right)) that arrived within
+    // `window` of each other. Each side keeps the values of the last `window` in a hash
+    // index by key, at most params.max_entries. Ends when both sources end
+    template<typename R, typename FL, typename FR, typename K = std::decay_t<std::invoke_result_t<FL, const I&>>>
+    Observable<I, R>& join(Observable<R>& other, FL key_left, FR key_right, std::chrono::nanoseconds window,
+        JoinParams params = {}) {
+        static_assert(sizeof...(T) == 1, "join() requires a single value observable");
+        static_assert(std::is_same_v<K, std::decay_t<std::invoke_result_t<FR, const R&>>>, "join() keys should be of the same type");
+        if (window.count() < 0 || params.max_entries == 0)
+            throw std::invalid_argument("join: window should not be negative, max_entries should be positive");
+        if (!params.now)
+            params.now = []() { return std::chrono::steady_clock::now().time_since_epoch(); };
+
+        struct State {
+            WindowJoinIndex<K, I> left;
+            WindowJoinIndex<K, R> right;
+            int active = 2;
+        };
+        return combine<Observable<I, R>>(other, "join",
+            [state = State{ WindowJoinIndex<K, I>(params.max_entries), WindowJoinIndex<K, R>(params.max_entries) },
+            key_left = std::move(key_left), key_right = std::move(key_right), window, now = std::move(params.now)]
+            (Observable<I, R>& proxy, CombineEvent<R>& event) mutable {
+            if (event.kind == NotificationKind::Error) {
+                proxy.error(event.descr);
+                return true;
+            }
+            if (event.kind == NotificationKind::End) {
+                if (--state.active != 0)
+                    return false;
+                proxy.end();
+                return true;
+            }
+
+            const auto time = now();
+            state.left.evict_before(time - window);
+            state.right.evict_before(time - window);
+            if (event.right) {
+                const auto& value = std::get<0>(*event.right_values);
+                const K key = key_right(value);
+                state.left.for_each(key, [&proxy, &value](const I& left) { proxy.next(left, value); });
+                state.right.insert(time, key, value);
+            } else {
+                const auto& value = std::get<0>(*event.left_values);
+                const K key = key_left(value);
+                state.right.for_each(key, [&proxy, &value](const R& right) { proxy.next(value, right); });
+                state.left.insert(time, key, value);
+            }
+            return false;
+        });
+    }
+
+    // Multicast: this observable is subscribed once, when the first subscriber subscribes
+    // to the returned observable, and unsubscribed when the last one leaves (which tears
+    // down map() / filter() / ... stages leading to this observable).
+    // Unlike intermediate observables, the returned one may be stored
+    std::shared_ptr<ConnectableObservable<T...>> share() {
+        return allocate<ConnectableObservable<T...>>(resource_, *this, true);
+    }
+
+    // Same as share(), but this observable is subscribed only by
+    // ConnectableObservable::connect(), regardless of the subscribers
+    std::shared_ptr<ConnectableObservable<T...>> publish() {
+        return allocate<ConnectableObservable<T...>>(resource_, *this, false);
+    }
+
+    // Expires when this observable is destroyed, for objects keeping its address
+    // (a moved-to observable gets a new one)
+    std::weak_ptr<const bool> lifetime() {
+        if (!lifetime_)
+            lifetime_ = allocate<bool>(resource_, true);
+        return lifetime_;
+    }
+
     void set_linked_info(Subscription subscription) {
         linked_subscription_ = std::move(subscription);
+        linked_subscription_->attach_node(node_);
+    }
+
+    // Subscription to one more source of a combining operator (merge(), zip(), ...),
+    // torn down along with the linked one
+    void add_linked_info(Subscription subscription) {
+        subscription.attach_node(node_);
+        combined_subscriptions_.push_back(std::move(subscription));
+    }
+
+    [[nodiscard]] std::pmr::memory_resource* get_memory_resource() const {
+        return resource_;
+    }
+
+protected:
+    // Called after a subscriber is added or removed
+    virtual void on_subscribers_changed() {}
+
+    [[nodiscard]] const std::shared_ptr<introspection::NodeCounters>& get_node() const {
+        return node_;
     }
 
 private:
-    std::shared_ptr<IExecutor> executor_{ nullptr };
+    void describe_node(introspection::NodeInfo& info) const {
+        for (const auto& subscriber : subscribers_) {
+            if (subscriber.is_removed())
+                continue;
+            introspection::SubscriberInfo item;
+            item.name = subscriber.get_trace_name();
+            switch (subscriber.get_execution_policy()) {
+            case ExecutionPolicy::NoExecutor:
+                item.executor = "none";
+                break;
+            case ExecutionPolicy::Executor:
+                item.executor = "executor";
+                item.executor_address = subscriber.get_executor().get();
+                break;
+            case ExecutionPolicy::KeyedExecutor:
+                item.executor = "keyed executor";
+                break;
+            }
+            if (const auto& node = subscriber.get_node())
+                item.target = node->id;
+            info.subscribers.push_back(std::move(item));
+        }
+    }
+
+    // Operators name their internal subscriptions, unless named() by the user
+    Observable& trace_as(const char* name) {
+        if (!trace_name_)
+            trace_name_ = name;
+        return *this;
+    }
+
+    // Defers removal of subscribers until the outermost emission ends.
+    // The destructor is the last thing done by next() / end() / error(),
+    // as removing subscribers may destroy this observable
+    class EmissionScope {
+    public:
+        explicit EmissionScope(Observable& observable)
+            : observable_{ observable } {
+            observable_.emitting_.fetch_add(1, std::memory_order_acq_rel);
+        }
+
+        ~EmissionScope() {
+            if (observable_.emitting_.fetch_sub(1, std::memory_order_acq_rel) == 1 && observable_.removed_count_ != 0)
+                observable_.remove_subscribers();
+        }
+
+        EmissionScope(const EmissionScope&) = delete;
+        EmissionScope& operator=(const EmissionScope&) = delete;
+
+    private:
+        Observable& observable_;
+    };
+
+    void remove_subscribers() {
+        if (removed_count_ == 0)
+            return;
+
+        const auto demand_before = demand_with_removed();
+        for (auto i = subscribers_.begin(); i != subscribers_.end();) {
+            if (i->is_removed()) {
+                const auto uuid = i->get_uuid();
+                subscriptions_.remove_if([&uuid](Subscription& s) {
+                    if (!(s.get_uuid() == uuid))
+                        return false;
+                    s.reset();
+                    return true;
+                });
+                i = subscribers_.erase(i);
+            } else {
+                ++i;
+            }
+        }
+        removed_count_ = 0;
+        executor_groups_dirty_ = true;
+        notify_demand(demand_before);
+        on_subscribers_changed();
+
+        if (!subscribers_.empty() || !linked_subscription_)
+            return;
+        // The source owns this observable: unsubscribing destroys it, so nothing
+        // can be touched after this call
+        auto linked_subscription = std::move(*linked_subscription_);
+        linked_subscription_.reset();
+        auto combined_subscriptions = std::move(combined_subscriptions_);
+        linked_subscription.unsubscribe();
+        for (auto& subscription : combined_subscriptions)
+            subscription.unsubscribe();
+    }
+
+    // Demand before removed subscribers leave
+    [[nodiscard]] uint64_t demand_with_removed() const {
+        uint64_t res = kUnboundedDemand;
+        for (const auto& subscriber : subscribers_) {
+            if (subscriber.has_demand())
+                res = std::min(res, subscriber.get_demand());
+        }
+        return res;
+    }
+
+    template<typename A, typename V = I>
+    Observable<typename A::Result>& sliding_window(SlidingWindow<A> window, std::function<std::chrono::nanoseconds()> now) {
+        using R = typename A::Result;
+        auto proxy_observable = allocate<Observable<R>>(resource_, resource_);
+        auto state = allocate<SlidingWindow<A>>(resource_, std::move(window));
+
+        auto subscription = this->trace_as("sliding").subscribe(
+            [proxy_observable, state, now = std::move(now)](const V& value) {
+            proxy_observable->next(state->add(value, now ? now() : std::chrono::nanoseconds{}));
+        },
+        [proxy_observable]() {
+            proxy_observable->end();
+        },
+        [proxy_observable](const std::string& descr) {
+            proxy_observable->error(descr);
+        });
+        proxy_observable->set_linked_info(subscription);
+        proxy_observable->forward_demand(subscription);
+        return *proxy_observable;
+    }
+
+    template<typename ...U>
+    friend class Observable;
+
+    enum class NotificationKind : uint8_t {
+        Value,
+        End,
+        Error
+    };
+
+    template<typename ...U>
+    struct CombineEvent {
+        // Event of `other` source
+        bool right = false;
+        NotificationKind kind = NotificationKind::Value;
+        std::optional<std::tuple<T...>> left_values;
+        std::optional<std::tuple<U...>> right_values;
+        std::string descr;
+    };
+
+    // Proxy fed by this and `other` observable. Events of both sources go through one
+    // SerializedDrain, so `handler` runs on one thread at a time. It's called with
+    // the proxy and the event and returns true when the proxy has ended, the events
+    // coming after that are dropped
+    template<typename P, typename ...U, typename H>
+    P& combine(Observable<U...>& other, const char* name, H handler) {
+        using Event = CombineEvent<U...>;
+        auto proxy_observable = allocate<P>(resource_, resource_);
+        auto drain = allocate<SerializedDrain<Event>>(resource_,
+            [proxy_observable, handler = std::move(handler), finished = false](Event& event) mutable {
+            if (!finished)
+                finished = handler(*proxy_observable, event);
+        });
+
+        auto on_end = [drain](bool right) {
+            return [drain, right]() { drain->push(Event{ right, NotificationKind::End, std::nullopt, std::nullopt, {} }); };
+        };
+        auto on_error = [drain](bool right) {
+            return [drain, right](const std::string& descr) {
+                drain->push(Event{ right, NotificationKind::Error, std::nullopt, std::nullopt, descr });
+            };
+        };
+        auto subscription = this->trace_as(name).subscribe(
+            [drain](const T&... args) {
+                drain->push(Event{ false, NotificationKind::Value, std::make_tuple(args...), std::nullopt, {} });
+            }, on_end(false), on_error(false));
+        auto other_subscription = other.trace_as(name).subscribe(
+            [drain](const U&... args) {
+                drain->push(Event{ true, NotificationKind::Value, std::nullopt, std::make_tuple(args...), {} });
+            }, on_end(true), on_error(true));
+        proxy_observable->set_linked_info(subscription);
+        proxy_observable->add_linked_info(other_subscription);
+        return *proxy_observable;
+    }
+
+    // Subscriptions taken so far no longer reach this observable
+    void invalidate_subscriptions() {
+        for (auto& s : subscriptions_) {
+            s.reset();
+        }
+        subscriptions_.clear();
+    }
+
+    // Operator nodes and their state are allocated from the memory resource of the source
+    template<typename N, typename ...Args>
+    static std::shared_ptr<N> allocate(std::pmr::memory_resource* resource, Args&&... args) {
+        return std::allocate_shared<N>(std::pmr::polymorphic_allocator<N>(resource), std::forward<Args>(args)...);
+    }
+
+    using Handlers = std::vector<std::function<void(const T&...)>>;
+
+    struct ExecutorGroup {
+        std::shared_ptr<IExecutor> executor;
+        // Snapshot: pending tasks keep calling subscribers that were there at emission
+        std::shared_ptr<const Handlers> handlers;
+    };
+
+    // Only serial executors: tasks of a parallel one (ThreadPoolExecutor) would run
+    // the subscribers one after another instead of in parallel
+    static bool is_coalescable(const Subscriber<T...>& subscriber) {
+        return subscriber.get_execution_policy() == ExecutionPolicy::Executor
+            && !subscriber.is_conflating()
+            && !subscriber.is_removed()
+            && subscriber.get_executor()->is_serial();
+    }
+
+    void update_executor_groups() {
+        executor_groups_dirty_ = false;
+        executor_groups_.clear();
+
+        std::unordered_map<const void*, size_t> group_index;
+        std::vector<std::pair<std::shared_ptr<IExecutor>, Handlers>> groups;
+        for (const auto& subscriber : subscribers_) {
+            if (!is_coalescable(subscriber))
+                continue;
+            const auto [it, inserted] = group_index.emplace(subscriber.get_executor().get(), groups.size());
+            if (inserted)
+                groups.emplace_back(subscriber.get_executor(), Handlers{});
+            if (const auto& node = subscriber.get_node()) {
+                groups[it->second].second.push_back([node, func = subscriber.get_function()](T... args) {
+                    introspection::invoke_counted(node.get(), [&]() { func(std::move(args)...); });
+                });
+            } else {
+                groups[it->second].second.push_back(subscriber.get_function());
+            }
+        }
+
+        for (auto& subscriber : subscribers_) {
+            const bool coalesced = is_coalescable(subscriber)
+                && groups[group_index[subscriber.get_executor().get()]].second.size() > 1;
+            subscriber.set_coalesced(coalesced);
+        }
+        for (auto& [executor, handlers] : groups) {
+            if (handlers.size() > 1)
+                executor_groups_.push_back({ std::move(executor), allocate<Handlers>(resource_, std::move(handlers)) });
+        }
+    }
+
+    void notify_demand(uint64_t demand_before) {
+        if (!on_demand_)
+            return;
+        const auto demand_after = demand();
+        if (demand_after == demand_before)
+            return;
+        if (demand_before == kUnboundedDemand) {
+            // First subscriber in the demand mode
+            on_demand_(demand_after);
+        } else if (demand_after == kUnboundedDemand) {
+            on_demand_(kUnboundedDemand);
+        } else if (demand_after > demand_before) {
+            on_demand_(demand_after - demand_before);
+        }
+    }
+
+    std::shared_ptr<IExecutor> executor_;
+    std::shared_ptr<KeyedExecutor> keyed_executor_;
+    std::function<size_t(const T&...)> key_hash_;
     ExecutionPolicy execution_policy_ = ExecutionPolicy::NoExecutor;
 
-    std::list<Subscriber<T...>> subscribers_;
-    std::list<Subscription> subscriptions_;
+    std::pmr::memory_resource* resource_;
+    std::pmr::list<Subscriber<T...>> subscribers_;
+    std::pmr::list<Subscription> subscriptions_;
+    std::vector<ExecutorGroup> executor_groups_;
+    bool executor_groups_dirty_ = false;
+    std::atomic<int> emitting_{ 0 };
+    size_t removed_count_ = 0;
     const Guid uuid_; // For debug purposes
 
     // linked - means that this observable is a proxy observable
     // made to allow subscribers to subscribe on map, filter or other function
     std::optional<Subscription> linked_subscription_;
+    std::vector<Subscription> combined_subscriptions_;
+
+    bool demand_mode_ = false;
+    bool conflate_mode_ = false;
+    ConflationKey<T...> conflate_key_;
+    const char* trace_name_ = nullptr;
+    std::shared_ptr<introspection::NodeCounters> node_;
+    std::function<void(uint64_t)> on_demand_;
+    // Set by forward_demand(): the subscribers of this proxy are in the demand mode
+    std::shared_ptr<std::atomic<bool>> upstream_demand_;
+    std::shared_ptr<bool> lifetime_;
+};
+
+// Observable returned by share() / publish(): values of the source observable
+// are emitted to all subscribers
+template<typename ...T>
+class ConnectableObservable : public Observable<T...> {
+public:
+    ConnectableObservable(Observable<T...>& source, bool auto_connect)
+        : Observable<T...>(source.get_memory_resource())
+        , source_{ &source }
+        , source_lifetime_{ source.lifetime() }
+        , auto_connect_{ auto_connect } {
+    }
+
+    ~ConnectableObservable() override {
+        disconnect();
+    }
+
+    ConnectableObservable(const ConnectableObservable&) = delete;
+    ConnectableObservable(ConnectableObservable&&) = delete;
+    ConnectableObservable& operator=(const ConnectableObservable&) = delete;
+    ConnectableObservable& operator=(ConnectableObservable&&) = delete;
+
+    // Subscribes to the source. Returns false if the source doesn't exist anymore
+    // (destroyed, or a map() / filter() / ... stage torn down by disconnect())
+    bool connect() {
+        if (connection_)
+            return true;
+        if (source_lifetime_.expired())
+            return false;
+
+        connection_ = source_->named("share").subscribe(
+            [this](const T&... args) { this->next(args...); },
+            [this]() { this->end(); },
+            [this](const std::string& descr) { this->error(descr); }
+        );
+        connection_->attach_node(this->get_node());
+        return true;
+    }
+
+    void disconnect() {
+        if (!connection_)
+            return;
+        auto connection = std::move(*connection_);
+        connection_.reset();
+        connection.unsubscribe();
+    }
+
+    [[nodiscard]] bool is_connected() const {
+        return connection_.has_value();
+    }
+
+protected:
+    void on_subscribers_changed() override {
+        if (!auto_connect_)
+            return;
+        if (this->subscribers_count() == 0)
+            disconnect();
+        else
+            connect();
+    }
+
+private:
+    Observable<T...>* source_;
+    std::weak_ptr<const bool> source_lifetime_;
+    bool auto_connect_;
+    std::optional<Subscription> connection_;
 };
 
 } // namespace tiny_rx
\ No newline at end of file
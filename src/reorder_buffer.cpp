@@ -0,0 +1,83 @@
+#include "reorder_buffer.h"
+
+#include "log.h"
+
+#include <stdexcept>
+
+namespace tiny_rx {
+
+ReorderBuffer::ReorderBuffer(size_t max_in_flight, std::shared_ptr<ReorderStats> stats)
+    : slots_(max_in_flight)
+    , stats_{ stats ? std::move(stats) : std::make_shared<ReorderStats>() } {
+    if (max_in_flight == 0)
+        throw std::invalid_argument("ReorderBuffer requires max_in_flight > 0");
+}
+
+uint64_t ReorderBuffer::acquire() {
+    auto lock = std::unique_lock<std::mutex>(mutex_);
+    if (next_seq_ - next_emit_ >= slots_.size()) {
+        if (draining_ && draining_thread_ == std::this_thread::get_id())
+            throw std::logic_error("ReorderBuffer: producer waits on the thread emitting results, it would never wake up");
+        ++stats_->producer_waits;
+        cond_var_.wait(lock, [this]() { return next_seq_ - next_emit_ < slots_.size(); });
+    }
+    return next_seq_++;
+}
+
+void ReorderBuffer::complete(uint64_t seq, std::function<void()> emit, bool terminal) {
+    auto lock = std::unique_lock<std::mutex>(mutex_);
+    slots_[seq % slots_.size()] = Slot{ std::move(emit), terminal };
+    ++buffered_;
+    if (seq != next_emit_)
+        ++stats_->reorder_stalls;
+    if (buffered_ > stats_->max_buffered)
+        stats_->max_buffered = buffered_;
+
+    // Only one thread emits at a time, others just leave their results
+    if (draining_)
+        return;
+    draining_ = true;
+    draining_thread_ = std::this_thread::get_id();
+
+    auto* slot = &slots_[next_emit_ % slots_.size()];
+    while (slot->emit) {
+        const auto task = std::move(slot->emit);
+        const auto task_terminal = slot->terminal;
+        *slot = Slot{};
+        --buffered_;
+        // Nothing is emitted after the end / error
+        const auto skip = finished_;
+        finished_ = finished_ || task_terminal;
+        lock.unlock();
+
+        if (!skip) {
+            try {
+                task();
+            } catch (const std::exception& e) {
+                log(utils::LogSeverity::Error, "ReorderBuffer exception on emit: ", e.what());
+            } catch (...) {
+                log(utils::LogSeverity::Error, "ReorderBuffer unknown exception on emit");
+            }
+            if (!task_terminal)
+                ++stats_->emitted;
+        }
+
+        lock.lock();
+        ++next_emit_;
+        cond_var_.notify_all();
+        slot = &slots_[next_emit_ % slots_.size()];
+    }
+    draining_ = false;
+    draining_thread_ = {};
+}
+
+size_t ReorderBuffer::in_flight() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<size_t>(next_seq_ - next_emit_);
+}
+
+const ReorderStats& ReorderBuffer::stats() const {
+    return *stats_;
+}
+
+} // namespace tiny_rx
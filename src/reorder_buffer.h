@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tiny_rx {
+
+struct ReorderStats {
+    // Emitted results, without the end / error notification
+    std::atomic<uint64_t> emitted{ 0 };
+    // Results completed before an earlier result and held in the buffer
+    std::atomic<uint64_t> reorder_stalls{ 0 };
+    // Times the producer was blocked because max_in_flight values were pending
+    std::atomic<uint64_t> producer_waits{ 0 };
+    std::atomic<size_t> max_buffered{ 0 };
+};
+
+// Bounded buffer restoring sequence order of results computed out of order.
+// Producer acquires a sequence number per value (blocking while max_in_flight
+// values are pending), workers complete sequence numbers in any order,
+// completions are emitted strictly in sequence order, one at a time.
+// Completions must come from other threads than the producer: acquire() waiting
+// on the thread that emits (e.g. a source fed back from downstream) throws
+// std::logic_error, other cases (an executor running tasks on the producer thread,
+// like RunLoopExecutor, or a producer occupying the only pool thread) deadlock
+class ReorderBuffer {
+public:
+    ReorderBuffer(size_t max_in_flight, std::shared_ptr<ReorderStats> stats);
+    ReorderBuffer(const ReorderBuffer&) = delete;
+    ReorderBuffer(ReorderBuffer&&) = delete;
+    ReorderBuffer& operator=(const ReorderBuffer&) = delete;
+    ReorderBuffer& operator=(ReorderBuffer&&) = delete;
+
+    uint64_t acquire();
+    // `terminal` - end / error notification: completions after it are dropped
+    void complete(uint64_t seq, std::function<void()> emit, bool terminal = false);
+
+    [[nodiscard]] size_t in_flight() const;
+    [[nodiscard]] const ReorderStats& stats() const;
+
+private:
+    struct Slot {
+        std::function<void()> emit;
+        bool terminal = false;
+    };
+
+    std::vector<Slot> slots_;
+    std::shared_ptr<ReorderStats> stats_;
+    mutable std::mutex mutex_;
+    std::condition_variable cond_var_;
+    uint64_t next_seq_ = 0;
+    uint64_t next_emit_ = 0;
+    size_t buffered_ = 0;
+    bool draining_ = false;
+    std::thread::id draining_thread_;
+    bool finished_ = false;
+};
+
+} // namespace tiny_rx
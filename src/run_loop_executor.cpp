@@ -11,7 +11,7 @@ void RunLoopExecutor::add_task(std::function<void()> f) {
 
 void RunLoopExecutor::dispatch() {
     std::unique_lock<std::mutex> lock(mutex_);
-    const auto task = tasks_.front();
+    const auto task = std::move(tasks_.front());
     tasks_.pop_front();
     lock.unlock();
 
@@ -12,12 +12,14 @@ namespace tiny_rx {
 // (e.g. Qt event loop, NoesisGui drawing loop etc.)
 class RunLoopExecutor : public IExecutor {
 public:
+    RunLoopExecutor() = default;
     RunLoopExecutor(const RunLoopExecutor&) = delete;
     RunLoopExecutor(RunLoopExecutor&&) = delete;
     RunLoopExecutor& operator=(const RunLoopExecutor&) = delete;
     RunLoopExecutor& operator=(RunLoopExecutor&&) = delete;
 
     void add_task(std::function<void()> f) override;
+    [[nodiscard]] bool is_serial() const override { return true; }
     void dispatch();
     size_t size() const;
 
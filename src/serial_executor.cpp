@@ -0,0 +1,54 @@
+#include "serial_executor.h"
+
+#include "log.h"
+
+namespace tiny_rx {
+
+namespace {
+// Max tasks executed in a row before giving the underlying thread back
+constexpr size_t kMaxTasksPerRun = 64;
+}
+
+SerialExecutor::SerialExecutor(std::shared_ptr<IExecutor> executor)
+    : executor_{ std::move(executor) } {
+}
+
+void SerialExecutor::add_task(std::function<void()> f) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.emplace_back(std::move(f));
+        if (scheduled_)
+            return;
+        scheduled_ = true;
+    }
+    executor_->add_task([self = shared_from_this()]() { self->run(); });
+}
+
+void SerialExecutor::run() {
+    for (size_t i = 0; i < kMaxTasksPerRun; ++i) {
+        auto lock = std::unique_lock<std::mutex>(mutex_);
+        if (tasks_.empty()) {
+            scheduled_ = false;
+            return;
+        }
+        const auto task = std::move(tasks_.front());
+        tasks_.pop_front();
+        lock.unlock();
+
+        try {
+            task();
+        } catch (const std::exception& e) {
+            log(utils::LogSeverity::Error, "SerialExecutor exception on task: ", e.what());
+        }
+    }
+
+    // Still have tasks - reschedule to let other lanes run
+    executor_->add_task([self = shared_from_this()]() { self->run(); });
+}
+
+size_t SerialExecutor::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tasks_.size();
+}
+
+} // namespace tiny_rx
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "iexecutor.h"
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace tiny_rx {
+
+// Executes tasks one at a time in the order they were added, using threads
+// of an underlying executor (e.g. ThreadPoolExecutor). Tasks of different
+// SerialExecutor objects sharing the same pool run in parallel.
+// Must be created with std::make_shared
+class SerialExecutor : public IExecutor, public std::enable_shared_from_this<SerialExecutor> {
+public:
+    explicit SerialExecutor(std::shared_ptr<IExecutor> executor);
+    SerialExecutor(const SerialExecutor&) = delete;
+    SerialExecutor(SerialExecutor&&) = delete;
+    SerialExecutor& operator=(const SerialExecutor&) = delete;
+    SerialExecutor& operator=(SerialExecutor&&) = delete;
+
+    void add_task(std::function<void()> f) override;
+    [[nodiscard]] bool is_serial() const override { return true; }
+    size_t size() const;
+
+private:
+    void run();
+
+    std::shared_ptr<IExecutor> executor_;
+    std::deque<std::function<void()>> tasks_;
+    mutable std::mutex mutex_;
+    bool scheduled_ = false;
+};
+
+} // namespace tiny_rx
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "log.h"
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <utility>
+
+namespace tiny_rx {
+
+// Serializes events pushed from several threads without locks (queue-drain).
+// A thread that finds the drain idle with an empty queue handles its event in place,
+// others put their events into a lock-free queue and leave: the handling thread takes
+// them before it becomes idle. So the handler runs on one thread at a time, in push order of
+// every producer, and its state needs no synchronization. Allocates only when
+// producers collide
+template<typename Event>
+class SerializedDrain {
+public:
+    explicit SerializedDrain(std::function<void(Event&)> handler)
+        : handler_{ std::move(handler) }
+        , head_{ &stub_ }
+        , tail_{ &stub_ } {
+    }
+
+    ~SerializedDrain() {
+        while (pop()) {
+        }
+        if (tail_ != &stub_)
+            delete tail_;
+    }
+
+    SerializedDrain(const SerializedDrain&) = delete;
+    SerializedDrain(SerializedDrain&&) = delete;
+    SerializedDrain& operator=(const SerializedDrain&) = delete;
+    SerializedDrain& operator=(SerializedDrain&&) = delete;
+
+    void push(Event event) {
+        int idle = 0;
+        if (wip_.load(std::memory_order_acquire) == 0 && wip_.compare_exchange_strong(idle, 1, std::memory_order_acq_rel)) {
+            // An idle drain may still hold events: a drain ends early when it meets a node
+            // that a producer has not linked yet. Those events were pushed earlier
+            if (head_.load(std::memory_order_acquire) == tail_) {
+                handle(event);
+                if (wip_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    return;
+            } else {
+                enqueue(std::move(event));
+            }
+        } else {
+            enqueue(std::move(event));
+            if (wip_.fetch_add(1, std::memory_order_acq_rel) != 0)
+                return;
+        }
+        drain();
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{ nullptr };
+        std::optional<Event> event;
+    };
+
+    void handle(Event& event) {
+        try {
+            handler_(event);
+        } catch (const std::exception& e) {
+            log(utils::LogSeverity::Error, "SerializedDrain exception in handler: ", e.what());
+        }
+    }
+
+    // Multiple producers, single consumer queue (intrusive, Vyukov)
+    void enqueue(Event event) {
+        auto node = new Node;
+        node->event.emplace(std::move(event));
+        const auto prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    // Consumer side: returns the next node holding an event. A node being linked by
+    // a producer is not seen yet, that producer drains it if the drain is idle by then
+    Node* pop() {
+        const auto next = tail_->next.load(std::memory_order_acquire);
+        if (!next)
+            return nullptr;
+        if (tail_ != &stub_)
+            delete tail_;
+        tail_ = next;
+        return next;
+    }
+
+    void drain() {
+        int missed = 1;
+        while (true) {
+            while (auto node = pop()) {
+                handle(*node->event);
+                node->event.reset();
+            }
+            missed = wip_.fetch_sub(missed, std::memory_order_acq_rel) - missed;
+            if (missed == 0)
+                return;
+        }
+    }
+
+    std::function<void(Event&)> handler_;
+    std::atomic<int> wip_{ 0 };
+    Node stub_;
+    std::atomic<Node*> head_;
+    Node* tail_;
+};
+
+} // namespace tiny_rx
@@ -12,7 +12,7 @@ SingleThreadExecutor::SingleThreadExecutor() {
             if (stop_thread_)
                 break;
 
-            const auto task = tasks_.front();
+            const auto task = std::move(tasks_.front());
             tasks_.pop_front();
             lock.unlock();
 
@@ -21,6 +21,7 @@ public:
     SingleThreadExecutor& operator=(SingleThreadExecutor&&) = delete;
 
     void add_task(std::function<void()> f) override;
+    [[nodiscard]] bool is_serial() const override { return true; }
 
 private:
     std::thread thread_;
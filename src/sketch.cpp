@@ -0,0 +1,298 @@
+#include "sketch.h"
+
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace tiny_rx {
+
+DDSketch::Store::Store(size_t max_buckets)
+    : max_buckets_{ max_buckets } {
+}
+
+void DDSketch::Store::add(int32_t index, uint64_t count) {
+    extend(index);
+    // Collapsed buckets are counted in the lowest one
+    index = std::max(index, offset_);
+    counts_[static_cast<size_t>(index - offset_)] += count;
+    total_ += count;
+}
+
+void DDSketch::Store::merge(const Store& other) {
+    for (size_t i = 0; i < other.counts_.size(); ++i) {
+        if (other.counts_[i] != 0)
+            add(other.offset_ + static_cast<int32_t>(i), other.counts_[i]);
+    }
+}
+
+int32_t DDSketch::Store::index_at_rank(uint64_t rank) const {
+    uint64_t passed = 0;
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        passed += counts_[i];
+        if (passed > rank)
+            return offset_ + static_cast<int32_t>(i);
+    }
+    return offset_ + static_cast<int32_t>(counts_.size()) - 1;
+}
+
+int32_t DDSketch::Store::index_at_rank_descending(uint64_t rank) const {
+    uint64_t passed = 0;
+    for (size_t i = counts_.size(); i-- > 0;) {
+        passed += counts_[i];
+        if (passed > rank)
+            return offset_ + static_cast<int32_t>(i);
+    }
+    return offset_;
+}
+
+uint64_t DDSketch::Store::total() const {
+    return total_;
+}
+
+// Makes the range of buckets include the index. When the range would exceed
+// max_buckets, the lowest buckets are collapsed into the lowest remaining one
+void DDSketch::Store::extend(int32_t index) {
+    if (counts_.empty()) {
+        offset_ = index;
+        counts_.assign(1, 0);
+        return;
+    }
+    // A full range keeps its lowest bucket for lower indexes, add() counts them there
+    if (counts_.size() == max_buckets_ && index < offset_)
+        return;
+
+    const int64_t low = offset_;
+    const int64_t high = offset_ + static_cast<int64_t>(counts_.size()) - 1;
+    const int64_t new_low = std::min<int64_t>(low, index);
+    const int64_t new_high = std::max<int64_t>(high, index);
+    const auto max_buckets = static_cast<int64_t>(max_buckets_);
+
+    if (new_high - new_low + 1 <= max_buckets) {
+        if (index < low) {
+            counts_.insert(counts_.begin(), static_cast<size_t>(low - index), 0);
+            offset_ = index;
+        } else if (index > high) {
+            counts_.resize(static_cast<size_t>(index - low + 1), 0);
+        }
+        return;
+    }
+
+    const int64_t floor = new_high - max_buckets + 1;
+    std::vector<uint64_t> counts(max_buckets_, 0);
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        const int64_t bucket = std::max<int64_t>(offset_ + static_cast<int64_t>(i), floor);
+        counts[static_cast<size_t>(bucket - floor)] += counts_[i];
+    }
+    counts_ = std::move(counts);
+    offset_ = static_cast<int32_t>(floor);
+}
+
+DDSketch::DDSketch(double relative_accuracy, size_t max_buckets)
+    : relative_accuracy_{ relative_accuracy }
+    , gamma_{ (1 + relative_accuracy) / (1 - relative_accuracy) }
+    , log_gamma_{ std::log(gamma_) }
+    , min_indexable_{ std::numeric_limits<double>::min() * gamma_ }
+    , positive_{ max_buckets }
+    , negative_{ max_buckets } {
+    if (!(relative_accuracy > 0 && relative_accuracy < 1) || max_buckets == 0)
+        throw std::invalid_argument("DDSketch: relative_accuracy should be in (0, 1), max_buckets should be positive");
+}
+
+void DDSketch::add(double value, uint64_t count) {
+    if (std::isnan(value) || count == 0)
+        return;
+
+    // Infinities have no bucket (the index would not fit)
+    if (value == std::numeric_limits<double>::infinity())
+        positive_infinity_count_ += count;
+    else if (value == -std::numeric_limits<double>::infinity())
+        negative_infinity_count_ += count;
+    else if (value > min_indexable_)
+        positive_.add(index(value), count);
+    else if (value < -min_indexable_)
+        negative_.add(index(-value), count);
+    else
+        zero_count_ += count;
+
+    if (count_ == 0) {
+        min_ = value;
+        max_ = value;
+    } else {
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+    count_ += count;
+    sum_ += value * static_cast<double>(count);
+}
+
+void DDSketch::merge(const DDSketch& other) {
+    if (other.gamma_ != gamma_)
+        throw std::invalid_argument("DDSketch: merged sketches should have the same accuracy");
+    if (other.count_ == 0)
+        return;
+
+    positive_.merge(other.positive_);
+    negative_.merge(other.negative_);
+    zero_count_ += other.zero_count_;
+    negative_infinity_count_ += other.negative_infinity_count_;
+    positive_infinity_count_ += other.positive_infinity_count_;
+    min_ = count_ == 0 ? other.min_ : std::min(min_, other.min_);
+    max_ = count_ == 0 ? other.max_ : std::max(max_, other.max_);
+    count_ += other.count_;
+    sum_ += other.sum_;
+}
+
+double DDSketch::quantile(double q) const {
+    if (count_ == 0)
+        return 0;
+
+    q = std::clamp(q, 0.0, 1.0);
+    auto rank = static_cast<uint64_t>(q * static_cast<double>(count_ - 1));
+    if (rank < negative_infinity_count_)
+        return -std::numeric_limits<double>::infinity();
+    if (rank >= count_ - positive_infinity_count_)
+        return std::numeric_limits<double>::infinity();
+    rank -= negative_infinity_count_;
+
+    const auto negative = negative_.total();
+    double res = 0;
+    if (rank < negative)
+        res = -value(negative_.index_at_rank_descending(rank));
+    else if (rank >= negative + zero_count_)
+        res = value(positive_.index_at_rank(rank - negative - zero_count_));
+    return std::clamp(res, min_, max_);
+}
+
+uint64_t DDSketch::count() const {
+    return count_;
+}
+
+double DDSketch::sum() const {
+    return sum_;
+}
+
+double DDSketch::min() const {
+    return min_;
+}
+
+double DDSketch::max() const {
+    return max_;
+}
+
+double DDSketch::relative_accuracy() const {
+    return relative_accuracy_;
+}
+
+int32_t DDSketch::index(double value) const {
+    return static_cast<int32_t>(std::ceil(std::log(value) / log_gamma_));
+}
+
+// Value with the relative error within accuracy for the whole bucket
+double DDSketch::value(int32_t index) const {
+    return 2 * std::pow(gamma_, index) / (gamma_ + 1);
+}
+
+FixedHistogram::FixedHistogram(std::vector<double> bounds)
+    : bounds_{ std::move(bounds) }
+    , counts_(bounds_.size() + 1, 0) {
+    if (!std::is_sorted(bounds_.begin(), bounds_.end()))
+        throw std::invalid_argument("FixedHistogram: bounds should be ascending");
+}
+
+FixedHistogram FixedHistogram::linear(double first, double width, size_t count) {
+    std::vector<double> bounds;
+    bounds.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+        bounds.push_back(first + width * static_cast<double>(i));
+    return FixedHistogram(std::move(bounds));
+}
+
+FixedHistogram FixedHistogram::exponential(double first, double factor, size_t count) {
+    std::vector<double> bounds;
+    bounds.reserve(count);
+    for (double bound = first; bounds.size() < count; bound *= factor)
+        bounds.push_back(bound);
+    return FixedHistogram(std::move(bounds));
+}
+
+void FixedHistogram::add(double value, uint64_t count) {
+    if (std::isnan(value) || count == 0)
+        return;
+
+    const auto bucket = std::lower_bound(bounds_.begin(), bounds_.end(), value) - bounds_.begin();
+    counts_[static_cast<size_t>(bucket)] += count;
+    if (count_ == 0) {
+        min_ = value;
+        max_ = value;
+    } else {
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+    count_ += count;
+}
+
+void FixedHistogram::merge(const FixedHistogram& other) {
+    if (other.bounds_ != bounds_)
+        throw std::invalid_argument("FixedHistogram: merged histograms should have the same bounds");
+    if (other.count_ == 0)
+        return;
+
+    for (size_t i = 0; i < counts_.size(); ++i)
+        counts_[i] += other.counts_[i];
+    min_ = count_ == 0 ? other.min_ : std::min(min_, other.min_);
+    max_ = count_ == 0 ? other.max_ : std::max(max_, other.max_);
+    count_ += other.count_;
+}
+
+double FixedHistogram::quantile(double q) const {
+    if (count_ == 0)
+        return 0;
+
+    const auto rank = std::clamp(q, 0.0, 1.0) * static_cast<double>(count_);
+    uint64_t passed = 0;
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        if (counts_[i] == 0)
+            continue;
+        if (static_cast<double>(passed + counts_[i]) >= rank) {
+            const auto lower = std::max(i == 0 ? min_ : bounds_[i - 1], min_);
+            const auto upper = std::min(i == bounds_.size() ? max_ : bounds_[i], max_);
+            const auto fraction = (rank - static_cast<double>(passed)) / static_cast<double>(counts_[i]);
+            return lower + (upper - lower) * fraction;
+        }
+        passed += counts_[i];
+    }
+    return max_;
+}
+
+uint64_t FixedHistogram::count() const {
+    return count_;
+}
+
+double FixedHistogram::min() const {
+    return min_;
+}
+
+double FixedHistogram::max() const {
+    return max_;
+}
+
+const std::vector<double>& FixedHistogram::bounds() const {
+    return bounds_;
+}
+
+const std::vector<uint64_t>& FixedHistogram::counts() const {
+    return counts_;
+}
+
+namespace detail {
+
+size_t thread_shard() {
+    static std::atomic<size_t> next_shard{ 0 };
+    thread_local const size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed);
+    return shard;
+}
+
+} // namespace detail
+
+} // namespace tiny_rx
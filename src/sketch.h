@@ -0,0 +1,165 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tiny_rx {
+
+// Quantile sketch with relative error guarantee (DDSketch): values are counted in
+// logarithmic buckets, so quantile(q) is within relative_accuracy of the exact value.
+// Memory depends on the range of values, not on their number: at most max_buckets
+// buckets per sign, the lowest buckets are collapsed beyond that (which affects only
+// the lowest quantiles). Infinities are counted separately and returned as is,
+// NaN is ignored. Sketches with the same accuracy are mergeable
+class DDSketch {
+public:
+    explicit DDSketch(double relative_accuracy = 0.01, size_t max_buckets = 2048);
+
+    void add(double value, uint64_t count = 1);
+    // Throws std::invalid_argument if the sketches have different accuracy
+    void merge(const DDSketch& other);
+
+    // q in [0, 1], 0 for an empty sketch
+    [[nodiscard]] double quantile(double q) const;
+    [[nodiscard]] uint64_t count() const;
+    [[nodiscard]] double sum() const;
+    [[nodiscard]] double min() const;
+    [[nodiscard]] double max() const;
+    [[nodiscard]] double relative_accuracy() const;
+
+private:
+    // Bucket counts for a contiguous range of indexes
+    class Store {
+    public:
+        explicit Store(size_t max_buckets);
+        void add(int32_t index, uint64_t count);
+        void merge(const Store& other);
+        // Index of the bucket containing the rank (0-based, ascending order of indexes)
+        [[nodiscard]] int32_t index_at_rank(uint64_t rank) const;
+        [[nodiscard]] int32_t index_at_rank_descending(uint64_t rank) const;
+        [[nodiscard]] uint64_t total() const;
+
+    private:
+        void extend(int32_t index);
+
+        size_t max_buckets_;
+        std::vector<uint64_t> counts_;
+        int32_t offset_ = 0;
+        uint64_t total_ = 0;
+    };
+
+    [[nodiscard]] int32_t index(double value) const;
+    [[nodiscard]] double value(int32_t index) const;
+
+    double relative_accuracy_;
+    double gamma_;
+    double log_gamma_;
+    double min_indexable_;
+    Store positive_;
+    Store negative_;
+    uint64_t zero_count_ = 0;
+    uint64_t negative_infinity_count_ = 0;
+    uint64_t positive_infinity_count_ = 0;
+    uint64_t count_ = 0;
+    double sum_ = 0;
+    double min_ = 0;
+    double max_ = 0;
+};
+
+// Histogram with fixed buckets: bucket i counts values in (bounds[i - 1], bounds[i]],
+// the last bucket - values above the last bound. Mergeable with histograms
+// of the same bounds
+class FixedHistogram {
+public:
+    // Upper bounds of the buckets, ascending
+    explicit FixedHistogram(std::vector<double> bounds);
+    // `count` buckets of `width` starting at `first`, or growing by `factor`
+    static FixedHistogram linear(double first, double width, size_t count);
+    static FixedHistogram exponential(double first, double factor, size_t count);
+
+    void add(double value, uint64_t count = 1);
+    // Throws std::invalid_argument if the bounds differ
+    void merge(const FixedHistogram& other);
+
+    // Interpolated within the bucket containing the rank, 0 for an empty histogram
+    [[nodiscard]] double quantile(double q) const;
+    [[nodiscard]] uint64_t count() const;
+    [[nodiscard]] double min() const;
+    [[nodiscard]] double max() const;
+    [[nodiscard]] const std::vector<double>& bounds() const;
+    // bounds().size() + 1 counts
+    [[nodiscard]] const std::vector<uint64_t>& counts() const;
+
+private:
+    std::vector<double> bounds_;
+    std::vector<uint64_t> counts_;
+    uint64_t count_ = 0;
+    double min_ = 0;
+    double max_ = 0;
+};
+
+namespace detail {
+// Small number unique to the calling thread, selects its shard
+size_t thread_shard();
+} // namespace detail
+
+// Mergeable sketch (DDSketch, FixedHistogram or a type with add(double) and
+// merge(const S&)) updated from several threads: each thread updates its own shard,
+// so updates from threads of a ThreadPoolExecutor don't contend, and snapshot()
+// merges the shards on demand
+template<typename S>
+class ShardedSketch {
+public:
+    // Shards are copies of the prototype. 0 shards - one per hardware thread
+    explicit ShardedSketch(const S& prototype, size_t shards = 0)
+        : prototype_{ prototype } {
+        if (shards == 0)
+            shards = std::max(1u, std::thread::hardware_concurrency());
+        shards_.reserve(shards);
+        for (size_t i = 0; i < shards; ++i)
+            shards_.push_back(std::make_unique<Shard>(prototype));
+    }
+
+    void add(double value) {
+        auto& shard = *shards_[detail::thread_shard() % shards_.size()];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.sketch.add(value);
+    }
+
+    // Merge of all shards
+    [[nodiscard]] S snapshot() const {
+        S res = prototype_;
+        for (const auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            res.merge(shard->sketch);
+        }
+        return res;
+    }
+
+    void reset() {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->sketch = prototype_;
+        }
+    }
+
+private:
+    // The mutex is taken only by the thread of the shard, unless
+    // several threads share it or a snapshot is made
+    struct alignas(64) Shard {
+        explicit Shard(const S& prototype)
+            : sketch{ prototype } {
+        }
+        mutable std::mutex mutex;
+        S sketch;
+    };
+
+    S prototype_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+} // namespace tiny_rx
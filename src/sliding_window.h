@@ -0,0 +1,147 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace tiny_rx {
+
+// Aggregations for Observable::sliding(). An aggregation combines values lifted to
+// its State with an associative combine(), identity() is the State of an empty window
+namespace window {
+
+template<typename V>
+struct Sum {
+    using State = V;
+    using Result = V;
+    static State identity() { return V{}; }
+    static State lift(const V& value) { return value; }
+    static State combine(const State& lhs, const State& rhs) { return lhs + rhs; }
+    static Result lower(const State& state) { return state; }
+};
+
+template<typename V>
+struct Min {
+    using State = V;
+    using Result = V;
+    static State identity() { return std::numeric_limits<V>::max(); }
+    static State lift(const V& value) { return value; }
+    static State combine(const State& lhs, const State& rhs) { return rhs < lhs ? rhs : lhs; }
+    static Result lower(const State& state) { return state; }
+};
+
+template<typename V>
+struct Max {
+    using State = V;
+    using Result = V;
+    static State identity() { return std::numeric_limits<V>::lowest(); }
+    static State lift(const V& value) { return value; }
+    static State combine(const State& lhs, const State& rhs) { return lhs < rhs ? rhs : lhs; }
+    static Result lower(const State& state) { return state; }
+};
+
+template<typename V>
+struct Average {
+    struct State {
+        double sum;
+        uint64_t count;
+    };
+    using Result = double;
+    static State identity() { return State{ 0.0, 0 }; }
+    static State lift(const V& value) { return State{ static_cast<double>(value), 1 }; }
+    static State combine(const State& lhs, const State& rhs) { return State{ lhs.sum + rhs.sum, lhs.count + rhs.count }; }
+    static Result lower(const State& state) { return state.count == 0 ? 0.0 : state.sum / static_cast<double>(state.count); }
+};
+
+} // namespace window
+
+// FIFO aggregation with O(1) amortized push / pop / query for any associative
+// aggregation (two-stack queue): new values go to the back stack, which keeps their
+// running aggregate; when the front stack runs out, the back stack is moved to it
+// as suffix aggregates. Nothing is recomputed per query and floating point sums
+// don't drift, as evicted values are never subtracted
+template<typename A>
+class SlidingAggregator {
+public:
+    using State = typename A::State;
+
+    void push(const State& state) {
+        back_.push_back(state);
+        back_aggregate_ = back_.size() == 1 ? state : A::combine(back_aggregate_, state);
+    }
+
+    // Removes the oldest value
+    void pop() {
+        if (front_.empty())
+            flip();
+        if (!front_.empty())
+            front_.pop_back();
+    }
+
+    [[nodiscard]] State query() const {
+        if (front_.empty())
+            return back_.empty() ? A::identity() : back_aggregate_;
+        return back_.empty() ? front_.back() : A::combine(front_.back(), back_aggregate_);
+    }
+
+    [[nodiscard]] size_t size() const {
+        return front_.size() + back_.size();
+    }
+
+private:
+    void flip() {
+        for (auto i = back_.rbegin(); i != back_.rend(); ++i)
+            front_.push_back(front_.empty() ? *i : A::combine(*i, front_.back()));
+        back_.clear();
+    }
+
+    // Aggregates of the older values: front_.back() covers all of them
+    std::vector<State> front_;
+    std::vector<State> back_;
+    State back_aggregate_ = A::identity();
+};
+
+// Window of the last `count` values or values of the last `duration`
+template<typename A>
+class SlidingWindow {
+public:
+    using Time = std::chrono::nanoseconds;
+
+    explicit SlidingWindow(size_t count)
+        : count_{ count } {
+    }
+
+    explicit SlidingWindow(Time duration)
+        : duration_{ duration } {
+    }
+
+    template<typename V>
+    typename A::Result add(const V& value, Time time = {}) {
+        if (duration_) {
+            while (!times_.empty() && times_.front() < time - *duration_) {
+                times_.pop_front();
+                aggregator_.pop();
+            }
+            times_.push_back(time);
+        } else if (aggregator_.size() == count_) {
+            aggregator_.pop();
+        }
+        aggregator_.push(A::lift(value));
+        return A::lower(aggregator_.query());
+    }
+
+    [[nodiscard]] size_t size() const {
+        return aggregator_.size();
+    }
+
+private:
+    size_t count_ = 0;
+    std::optional<Time> duration_;
+    std::deque<Time> times_;
+    SlidingAggregator<A> aggregator_;
+};
+
+} // namespace tiny_rx
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "async_file_writer.h"
+#include "codec.h"
+#include "mapped_file_source.h"
+#include "observable.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace tiny_rx {
+
+// Stream log layout: 8 bytes magic, then records of
+// [kind: uint8][timestamp, ns since recording start: int64][payload size: uint32][payload]
+// Value payload is the values encoded with Codec<T> one after another,
+// error payload is the encoded description, end has no payload
+namespace stream_log {
+
+inline constexpr char kMagic[8] = { 'T', 'R', 'X', 'L', 'O', 'G', '0', '1' };
+inline constexpr size_t kRecordHeaderSize = sizeof(uint8_t) + sizeof(int64_t) + sizeof(uint32_t);
+
+enum class RecordKind : uint8_t {
+    Value = 0,
+    End = 1,
+    Error = 2
+};
+
+} // namespace stream_log
+
+// Subscriber object writing the stream to a binary log, e.g.
+// auto subscription = source.subscribe(std::make_shared<StreamRecorder<int>>("stream.log"));
+// The emitting thread only encodes the values into a buffer, file is written in background
+template<typename ...T>
+class StreamRecorder {
+public:
+    explicit StreamRecorder(const std::string& path, size_t buffer_size = 1024 * 1024)
+        : writer_{ path, buffer_size }
+        , start_{ std::chrono::steady_clock::now() } {
+        writer_.write(stream_log::kMagic, sizeof(stream_log::kMagic));
+    }
+
+    void on_next(const T&... values) {
+        record(stream_log::RecordKind::Value, [&values...](std::vector<char>& out) {
+            (Codec<T>::encode(values, out), ...);
+        });
+    }
+
+    void on_end() {
+        record(stream_log::RecordKind::End, [](std::vector<char>&) {});
+        writer_.flush();
+    }
+
+    void on_error(const std::string& descr) {
+        record(stream_log::RecordKind::Error, [&descr](std::vector<char>& out) {
+            Codec<std::string>::encode(descr, out);
+        });
+    }
+
+    void flush() {
+        writer_.flush();
+    }
+
+private:
+    template<typename F>
+    void record(stream_log::RecordKind kind, F encode_payload) {
+        thread_local std::vector<char> buffer;
+        buffer.clear();
+
+        const auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_).count();
+        Codec<uint8_t>::encode(static_cast<uint8_t>(kind), buffer);
+        Codec<int64_t>::encode(static_cast<int64_t>(timestamp), buffer);
+        Codec<uint32_t>::encode(0, buffer);
+        encode_payload(buffer);
+
+        const auto payload_size = static_cast<uint32_t>(buffer.size() - stream_log::kRecordHeaderSize);
+        std::memcpy(buffer.data() + sizeof(uint8_t) + sizeof(int64_t), &payload_size, sizeof(payload_size));
+        writer_.write(buffer.data(), buffer.size());
+    }
+
+    AsyncFileWriter writer_;
+    const std::chrono::steady_clock::time_point start_;
+};
+
+enum class ReplaySpeed {
+    AsFastAsPossible,
+    Original // keeps recorded intervals between records
+};
+
+// Reads a log written by StreamRecorder<T...> and emits it to an observable
+template<typename ...T>
+class StreamReplayer {
+public:
+    explicit StreamReplayer(const std::string& path)
+        : file_{ path } {
+        if (file_.size() < sizeof(stream_log::kMagic) ||
+            std::memcmp(file_.data(), stream_log::kMagic, sizeof(stream_log::kMagic)) != 0) {
+            throw std::runtime_error("StreamReplayer: not a stream log " + path);
+        }
+        file_.advise_sequential();
+    }
+
+    // A corrupt or truncated record is emitted as error(), the replay stops there
+    void replay(Observable<T...>& observable, ReplaySpeed speed = ReplaySpeed::AsFastAsPossible) {
+        const char* data = file_.data() + sizeof(stream_log::kMagic);
+        const char* const end = file_.data() + file_.size();
+        const auto start = std::chrono::steady_clock::now();
+
+        while (data < end) {
+            Record record;
+            try {
+                record = read_record(data, end);
+            } catch (const std::runtime_error& e) {
+                observable.error(e.what());
+                return;
+            }
+
+            if (speed == ReplaySpeed::Original)
+                std::this_thread::sleep_until(start + std::chrono::nanoseconds(record.timestamp));
+
+            switch (record.kind) {
+            case stream_log::RecordKind::Value:
+                std::apply([&observable](const T&... args) { observable.next(args...); }, *record.values);
+                break;
+            case stream_log::RecordKind::End:
+                observable.end();
+                break;
+            case stream_log::RecordKind::Error:
+                observable.error(record.descr);
+                break;
+            }
+        }
+    }
+
+private:
+    struct Record {
+        stream_log::RecordKind kind{ stream_log::RecordKind::End };
+        int64_t timestamp{ 0 };
+        std::optional<std::tuple<T...>> values;
+        std::string descr;
+    };
+
+    // Throws std::runtime_error when the record is corrupt or truncated
+    static Record read_record(const char*& data, const char* end) {
+        Record record;
+        record.kind = static_cast<stream_log::RecordKind>(Codec<uint8_t>::decode(data, end));
+        record.timestamp = Codec<int64_t>::decode(data, end);
+        const auto payload_size = Codec<uint32_t>::decode(data, end);
+        if (static_cast<size_t>(end - data) < payload_size)
+            throw std::runtime_error("StreamReplayer: truncated record");
+        const char* payload = data;
+        const char* const payload_end = data + payload_size;
+        data = payload_end;
+
+        switch (record.kind) {
+        case stream_log::RecordKind::Value:
+            // Braced initialization guarantees left to right decoding order
+            record.values = std::tuple<T...>{ Codec<T>::decode(payload, payload_end)... };
+            break;
+        case stream_log::RecordKind::End:
+            break;
+        case stream_log::RecordKind::Error:
+            record.descr = Codec<std::string>::decode(payload, payload_end);
+            break;
+        default:
+            throw std::runtime_error("StreamReplayer: unknown record kind");
+        }
+        return record;
+    }
+
+    MappedFile file_;
+};
+
+} // namespace tiny_rx
@@ -1,12 +1,20 @@
 #pragma once
 
+#include "conflator.h"
+#include "demand.h"
 #include "execution_policy.h"
 #include "guid.h"
 #include "iexecutor.h"
+#include "introspection.h"
+#include "keyed_executor.h"
 #include "log.h"
+#include "tracer.h"
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <memory_resource>
 
 namespace tiny_rx {
 
@@ -35,8 +43,8 @@ public:
 
     // We want no copy assignment, so use explicit && here
     Subscriber& operator=(Subscriber&& other) noexcept {
-        trace_func(__PRETTY_FUNCTION__, other.uuid_);
-        other.swap(this);
+        trace_call(__PRETTY_FUNCTION__, other.uuid_);
+        other.swap(*this);
         return *this;
     }
 
@@ -44,8 +52,10 @@ public:
         return uuid_;
     }
 
-    void set_function(std::function<void(T...)> func) {
-        func_ = std::move(func);
+    // The shared handler is allocated from `resource`
+    void set_function(std::function<void(const T&...)> func, std::pmr::memory_resource* resource) {
+        using Function = std::function<void(const T&...)>;
+        func_ = std::allocate_shared<Function>(std::pmr::polymorphic_allocator<Function>(resource), std::move(func));
     }
 
     void set_on_end(std::function<void()> func) {
@@ -64,11 +74,115 @@ public:
         executor_ = std::move(executor);
     }
 
-    void on_next(T ...values) {
+    [[nodiscard]] ExecutionPolicy get_execution_policy() const {
+        return execution_policy_;
+    }
+
+    [[nodiscard]] const std::shared_ptr<IExecutor>& get_executor() const {
+        return executor_;
+    }
+
+    [[nodiscard]] const std::function<void(const T&...)>& get_function() const {
+        return *func_;
+    }
+
+    // Name of the callback in traces
+    void set_trace_name(const char* name) {
+        trace_name_ = name;
+    }
+
+    [[nodiscard]] const char* get_trace_name() const {
+        return trace_name_;
+    }
+
+    // Introspection counters of the node fed by this subscriber
+    void set_node(std::shared_ptr<introspection::NodeCounters> node) {
+        node_ = std::move(node);
+    }
+
+    [[nodiscard]] const std::shared_ptr<introspection::NodeCounters>& get_node() const {
+        return node_;
+    }
+
+    // Unsubscribed during an emission, removed from the observable when it ends
+    void mark_removed() {
+        removed_ = true;
+    }
+
+    [[nodiscard]] bool is_removed() const {
+        return removed_;
+    }
+
+    // Latest-value delivery on the executor, see Conflator.
+    // key (optional) - keeps the latest value per key. The conflator is allocated from `resource`
+    void enable_conflation(ConflationKey<T...> key, std::pmr::memory_resource* resource) {
+        conflator_ = std::allocate_shared<Conflator<T...>>(std::pmr::polymorphic_allocator<Conflator<T...>>(resource),
+                                                           *func_, std::move(key));
+    }
+
+    [[nodiscard]] bool is_conflating() const {
+        return conflator_ != nullptr;
+    }
+
+    // Coalesced subscribers receive values through the observable's shared executor task
+    void set_coalesced(bool coalesced) {
+        coalesced_ = coalesced;
+    }
+
+    [[nodiscard]] bool is_coalesced() const {
+        return coalesced_;
+    }
+
+    void set_keyed_executor(std::shared_ptr<KeyedExecutor> executor, std::function<size_t(const T&...)> key_hash) {
+        keyed_executor_ = std::move(executor);
+        key_hash_ = std::move(key_hash);
+    }
+
+    // Demand flow control: once enabled, the subscriber counts values it's ready to receive.
+    // Enabled when the subscriber is set up (Observable::with_demand()) or by the first
+    // request(). The counter lives in the subscriber, so enabling it from another thread
+    // doesn't race with emission
+    void enable_demand() {
+        demand_mode_.store(true, std::memory_order_release);
+    }
+
+    void add_demand(uint64_t n) {
+        auto current = demand_.load();
+        while (!demand_.compare_exchange_weak(current, tiny_rx::add_demand(current, n))) {
+        }
+        enable_demand();
+    }
+
+    [[nodiscard]] bool has_demand() const {
+        return demand_mode_.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] uint64_t get_demand() const {
+        return has_demand() ? demand_.load() : kUnboundedDemand;
+    }
+
+    void consume_demand() {
+        if (!has_demand())
+            return;
+        auto current = demand_.load();
+        while (current != 0 && current != kUnboundedDemand && !demand_.compare_exchange_weak(current, current - 1)) {
+        }
+    }
+
+    void on_next(const T&... values) {
         if (execution_policy_ == ExecutionPolicy::NoExecutor) {
-            func_(values...);
+            trace::Span span(trace_name_);
+            if (node_)
+                introspection::invoke_counted(node_.get(), [&]() { (*func_)(values...); });
+            else
+                (*func_)(values...);
+        } else if (execution_policy_ == ExecutionPolicy::Executor) {
+            if (conflator_)
+                conflator_->push(*executor_, values...);
+            else
+                executor_->add_task(make_task(values...));
         } else {
-            executor_->add_task(std::bind(func_, values...));
+            keyed_executor_->add_task(key_hash_(values...), make_task(values...));
         }
     }
 
@@ -78,8 +192,10 @@ public:
 
         if (execution_policy_ == ExecutionPolicy::NoExecutor) {
             end_func_();
-        } else {
+        } else if (execution_policy_ == ExecutionPolicy::Executor) {
             executor_->add_task(end_func_);
+        } else {
+            keyed_executor_->add_barrier_task(end_func_);
         }
     }
 
@@ -89,12 +205,21 @@ public:
 
         if (execution_policy_ == ExecutionPolicy::NoExecutor) {
             error_func_(std::move(descr));
-        } else {
+        } else if (execution_policy_ == ExecutionPolicy::Executor) {
             executor_->add_task(std::bind(error_func_, std::move(descr)));
+        } else {
+            keyed_executor_->add_barrier_task(std::bind(error_func_, std::move(descr)));
         }
     }
 
 private:
+    // The task shares the handler instead of copying it
+    std::function<void()> make_task(const T&... values) const {
+        return trace::traced(trace_name_, introspection::counted(node_, [func = func_, values...]() {
+            (*func)(values...);
+        }));
+    }
+
     void swap(Subscriber& other) noexcept {
         std::swap(uuid_, other.uuid_);
         std::swap(func_, other.func_);
@@ -102,14 +227,33 @@ private:
         std::swap(error_func_, other.error_func_);
         std::swap(execution_policy_, other.execution_policy_);
         std::swap(executor_, other.executor_);
+        std::swap(keyed_executor_, other.keyed_executor_);
+        std::swap(key_hash_, other.key_hash_);
+        // Subscribers are swapped only before they are published
+        demand_.store(other.demand_.exchange(demand_.load()));
+        demand_mode_.store(other.demand_mode_.exchange(demand_mode_.load()));
+        std::swap(coalesced_, other.coalesced_);
+        std::swap(conflator_, other.conflator_);
+        std::swap(removed_, other.removed_);
+        std::swap(trace_name_, other.trace_name_);
+        std::swap(node_, other.node_);
     }
 
     Guid uuid_;
-    std::function<void(T...)> func_;
+    std::shared_ptr<const std::function<void(const T&...)>> func_;
     std::function<void()> end_func_;
     std::function<void(std::string)> error_func_;
     ExecutionPolicy execution_policy_ = ExecutionPolicy::NoExecutor;
     std::shared_ptr<IExecutor> executor_;
+    std::shared_ptr<KeyedExecutor> keyed_executor_;
+    std::function<size_t(const T&...)> key_hash_;
+    std::atomic<uint64_t> demand_{ 0 };
+    std::atomic<bool> demand_mode_{ false };
+    bool coalesced_ = false;
+    std::shared_ptr<Conflator<T...>> conflator_;
+    bool removed_ = false;
+    const char* trace_name_ = "subscriber";
+    std::shared_ptr<introspection::NodeCounters> node_;
 };
 
 } // namespace tiny_rx
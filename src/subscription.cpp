@@ -11,11 +11,22 @@ Subscription::Subscription() {
     trace_call(__PRETTY_FUNCTION__, uuid_);
 }
 
-Subscription::Subscription(IObservable* observable, const Guid& subscriber_id) {
+Subscription::Subscription(IObservable* observable, const Guid& subscriber_id, std::pmr::memory_resource* resource) {
     trace_call(__PRETTY_FUNCTION__, uuid_);
     observable_ = observable;
     subscriber_uuid_ = subscriber_id;
-    valid_ = std::make_shared<bool>(true);
+    if (resource)
+        valid_ = std::allocate_shared<bool>(std::pmr::polymorphic_allocator<bool>(resource), true);
+    else
+        valid_ = std::make_shared<bool>(true);
+}
+
+Subscription::Subscription(IObservable* observable, const Guid& subscriber_id, std::shared_ptr<bool> valid) {
+    trace_call(__PRETTY_FUNCTION__, uuid_);
+    observable_ = observable;
+    subscriber_uuid_ = subscriber_id;
+    valid_ = std::move(valid);
+    shared_valid_ = true;
 }
 
 Subscription::Subscription(const Subscription& other) {
@@ -24,6 +35,7 @@ Subscription::Subscription(const Subscription& other) {
     observable_ = other.observable_;
     subscriber_uuid_ = other.subscriber_uuid_;
     valid_ = other.valid_;
+    shared_valid_ = other.shared_valid_;
 }
 
 Subscription::Subscription(Subscription&& other) noexcept
@@ -33,13 +45,14 @@ Subscription::Subscription(Subscription&& other) noexcept
 }
 
 Subscription& Subscription::operator=(Subscription other) noexcept {
-    trace_call(__PRETTY_FUNCTION__, uuid_, "other uuid_ = " + other.uuid_.to_string());
+    trace_call(__PRETTY_FUNCTION__, uuid_, "other uuid_ = ", other.uuid_);
     other.swap(*this);
     return *this;
 }
 
 void Subscription::swap(Subscription& other) noexcept {
     std::swap(valid_, other.valid_);
+    std::swap(shared_valid_, other.shared_valid_);
     std::swap(observable_, other.observable_);
     std::swap(subscriber_uuid_, other.subscriber_uuid_);
     std::swap(uuid_, other.uuid_);
@@ -49,22 +62,33 @@ Subscription::~Subscription() {
     trace_call(__PRETTY_FUNCTION__, uuid_);
 }
 
+bool Subscription::is_valid() const {
+    return valid_ && *valid_;
+}
+
 void Subscription::reset() {
-    *valid_ = false;
+    if (shared_valid_)
+        valid_.reset();
+    else if (valid_)
+        *valid_ = false;
 }
 
 void Subscription::unsubscribe() {
-    if (*valid_) {
-        auto linked_subscription = observable_->get_linked_subscription();
-        if (!linked_subscription || observable_->subscribers_count() != 1) {
-            observable_->unsubscribe(subscriber_uuid_);
-        } else {
-            linked_subscription->unsubscribe();
-        }
-    }
+    if (is_valid())
+        observable_->unsubscribe(subscriber_uuid_);
     reset();
 }
 
+void Subscription::request(uint64_t n) {
+    if (is_valid())
+        observable_->request(subscriber_uuid_, n);
+}
+
+void Subscription::attach_node(std::shared_ptr<introspection::NodeCounters> node) {
+    if (is_valid() && node)
+        observable_->attach_node(subscriber_uuid_, std::move(node));
+}
+
 Guid Subscription::get_uuid() const {
     return subscriber_uuid_;
 }
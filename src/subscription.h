@@ -2,14 +2,20 @@
 
 #include "iobservable.h"
 
+#include <cstdint>
 #include <memory>
+#include <memory_resource>
 
 namespace tiny_rx {
 
 class Subscription {
 public:
     Subscription();
-    Subscription(IObservable* observable, const Guid& subscriber_id);
+    // The validity flag shared by copies is allocated from `resource`
+    Subscription(IObservable* observable, const Guid& subscriber_id, std::pmr::memory_resource* resource = nullptr);
+    // Shares the validity flag with the observable and its other subscriptions, the observable
+    // resets it on destruction. unsubscribe() / reset() only detach this subscription from it
+    Subscription(IObservable* observable, const Guid& subscriber_id, std::shared_ptr<bool> valid);
     // TODO: remove these operations - they're here for debug purposes only
     Subscription(const Subscription& other);
     Subscription(Subscription&& other) noexcept;
@@ -18,12 +24,21 @@ public:
 
     void reset();
     void unsubscribe();
+    // Demand flow control: the subscriber is ready to receive n more values.
+    // The first call switches the subscriber to the demand mode
+    // (unless it subscribed with Observable::with_demand())
+    void request(uint64_t n);
+    // Introspection: the subscriber feeds the node
+    void attach_node(std::shared_ptr<introspection::NodeCounters> node);
     [[nodiscard]] Guid get_uuid() const;
 
 private:
     void swap(Subscription& other) noexcept;
+    [[nodiscard]] bool is_valid() const;
 
-    std::shared_ptr<bool> valid_ = std::make_shared<bool>(false);
+    // Empty for default constructed (never valid) subscriptions
+    std::shared_ptr<bool> valid_;
+    bool shared_valid_ = false;
     IObservable* observable_{nullptr};
     Guid subscriber_uuid_;
     Guid uuid_;
@@ -14,7 +14,7 @@ ThreadPoolExecutor::ThreadPoolExecutor(size_t pool_size) : pool_size_(pool_size)
                 if (stop_thread_)
                     break;
 
-                const auto task = tasks_.front();
+                const auto task = std::move(tasks_.front());
                 tasks_.pop_front();
                 lock.unlock();
 
@@ -1,10 +1,30 @@
 #pragma once
 
+#include "allocation_tracker.h"
+#include "batch_kernels.h"
+#include "broadcast_observable.h"
+#include "cold_source.h"
+#include "columnar_batch.h"
+#include "compact_observable.h"
+#include "distinct.h"
+#include "file_sink.h"
 #include "guid.h"
+#include "introspection.h"
+#include "keyed_executor.h"
 #include "log.h"
+#include "mapped_file_source.h"
+#include "memory_resource.h"
 #include "observable.h"
 #include "run_loop_executor.h"
+#include "serial_executor.h"
+#include "serialized_drain.h"
 #include "single_thread_executor.h"
+#include "sketch.h"
+#include "sliding_window.h"
+#include "stream_recorder.h"
 #include "subscriber.h"
 #include "subscription.h"
 #include "thread_pool_executor.h"
+#include "tracer.h"
+#include "virtual_time_executor.h"
+#include "window_join.h"
@@ -0,0 +1,223 @@
+#include "tracer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+namespace tiny_rx::trace {
+
+namespace {
+
+struct ThreadBuffer {
+    ThreadBuffer(uint32_t thread_id, size_t capacity)
+        : tid{ thread_id }
+        , records(capacity) {
+    }
+
+    const uint32_t tid;
+    std::vector<Record> records;
+    // Written by the owning thread only, read by the export
+    std::atomic<size_t> size{ 0 };
+    std::atomic<uint64_t> dropped{ 0 };
+    std::atomic<bool> thread_exited{ false };
+};
+
+struct Registry {
+    std::mutex mutex;
+    // Buffers outlive their threads to be exported, until clear()
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    size_t capacity = 1 << 16;
+    uint32_t next_tid = 1;
+    std::unordered_set<std::string> names;
+    std::atomic<uint64_t> next_event{ 1 };
+    std::atomic<uint64_t> next_flow{ 1 };
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+// Marks the buffer of the thread when it exits, so clear() can release it
+struct ThreadExitMarker {
+    ~ThreadExitMarker() {
+        if (buffer)
+            buffer->thread_exited.store(true, std::memory_order_release);
+    }
+
+    ThreadBuffer* buffer = nullptr;
+};
+
+// Plain pointer for record(), the marker has a destructor and is touched once per thread
+thread_local ThreadBuffer* thread_buffer = nullptr;
+thread_local ThreadExitMarker thread_exit_marker;
+thread_local uint64_t thread_event = 0;
+
+ThreadBuffer& get_thread_buffer() {
+    if (!thread_buffer) {
+        auto& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.buffers.push_back(std::make_shared<ThreadBuffer>(r.next_tid++, r.capacity));
+        thread_buffer = r.buffers.back().get();
+        thread_exit_marker.buffer = thread_buffer;
+    }
+    return *thread_buffer;
+}
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void write_escaped(std::ostream& out, const char* str) {
+    for (; *str; ++str) {
+        const char c = *str;
+        if (c == '"' || c == '\\')
+            out << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20)
+            out << ' ';
+        else
+            out << c;
+    }
+}
+
+} // namespace
+
+void enable(bool on) {
+    detail::enabled.store(on);
+}
+
+void set_buffer_capacity(size_t records) {
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.capacity = records;
+}
+
+void clear() {
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.buffers.erase(std::remove_if(r.buffers.begin(), r.buffers.end(), [](const auto& buffer) {
+        return buffer->thread_exited.load(std::memory_order_acquire);
+    }), r.buffers.end());
+    for (auto& buffer : r.buffers) {
+        buffer->size = 0;
+        buffer->dropped = 0;
+    }
+}
+
+size_t buffers_count() {
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    return r.buffers.size();
+}
+
+uint64_t dropped() {
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    uint64_t res = 0;
+    for (const auto& buffer : r.buffers)
+        res += buffer->dropped.load();
+    return res;
+}
+
+const char* intern(std::string_view name) {
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    return r.names.emplace(name).first->c_str();
+}
+
+void record(Phase phase, const char* name, uint64_t event, uint64_t flow) {
+    auto& buffer = get_thread_buffer();
+    const auto index = buffer.size.load(std::memory_order_relaxed);
+    if (index >= buffer.records.size()) {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer.records[index] = Record{ now_ns(), event, flow, name, phase };
+    buffer.size.store(index + 1, std::memory_order_release);
+}
+
+uint64_t current_event() {
+    return thread_event;
+}
+
+EventScope::EventScope() {
+    if (!enabled() || thread_event != 0)
+        return;
+    active_ = true;
+    thread_event = registry().next_event.fetch_add(1, std::memory_order_relaxed);
+    record(Phase::Instant, "emit", thread_event);
+}
+
+EventScope::EventScope(uint64_t event)
+    : active_{ true }
+    , previous_{ thread_event } {
+    thread_event = event;
+}
+
+EventScope::~EventScope() {
+    if (active_)
+        thread_event = previous_;
+}
+
+std::function<void()> traced(const char* name, std::function<void()> task) {
+    if (!enabled())
+        return task;
+
+    const auto event = current_event();
+    const auto flow = registry().next_flow.fetch_add(1, std::memory_order_relaxed);
+    record(Phase::FlowStart, "queue", event, flow);
+    return [name, event, flow, task = std::move(task)]() {
+        EventScope event_scope(event);
+        Span span(name);
+        record(Phase::FlowEnd, "queue", event, flow);
+        task();
+    };
+}
+
+void write_chrome_json(std::ostream& out) {
+    auto& r = registry();
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        buffers = r.buffers;
+    }
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for (const auto& buffer : buffers) {
+        const auto size = buffer->size.load(std::memory_order_acquire);
+        for (size_t i = 0; i < size; ++i) {
+            const auto& rec = buffer->records[i];
+            out << (first ? "\n" : ",\n");
+            first = false;
+            out << "{\"name\":\"";
+            write_escaped(out, rec.name);
+            out << "\",\"cat\":\"tiny_rx\",\"ph\":\"" << static_cast<char>(rec.phase) << "\",\"ts\":"
+                << rec.ts_ns / 1000 << '.' << std::to_string(1000 + rec.ts_ns % 1000).substr(1)
+                << ",\"pid\":1,\"tid\":" << buffer->tid;
+            if (rec.phase == Phase::FlowStart || rec.phase == Phase::FlowEnd)
+                out << ",\"id\":" << rec.flow;
+            if (rec.phase == Phase::FlowEnd)
+                out << ",\"bp\":\"e\"";
+            if (rec.phase == Phase::Instant)
+                out << ",\"s\":\"t\"";
+            out << ",\"args\":{\"event\":" << rec.event << "}}";
+        }
+    }
+    out << "\n]}\n";
+}
+
+void save_chrome_json(const std::string& path) {
+    std::ofstream out(path);
+    if (!out)
+        throw std::runtime_error("Unable to open trace file " + path);
+    write_chrome_json(out);
+}
+
+} // namespace tiny_rx::trace
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace tiny_rx::trace {
+
+// Opt-in per-event tracing. Every top level emission gets an event id, which is carried
+// through operators and executors. Recorded:
+// - emission of a new event (instant)
+// - enqueue / dequeue of executor tasks ("queue" flow arrows between threads)
+// - entry / exit of subscriber and operator callbacks (slices named after the operator
+//   or Observable::named())
+// Records are stored in fixed-size per-thread buffers without locks (records beyond the
+// capacity are dropped) and exported as Chrome trace JSON (chrome://tracing, Perfetto)
+
+enum class Phase : char {
+    Begin = 'B',
+    End = 'E',
+    Instant = 'i',
+    FlowStart = 's',
+    FlowEnd = 'f'
+};
+
+struct Record {
+    int64_t ts_ns;
+    uint64_t event;
+    uint64_t flow;
+    const char* name;
+    Phase phase;
+};
+
+namespace detail {
+inline std::atomic<bool> enabled{ false };
+} // namespace detail
+
+inline bool enabled() {
+    return detail::enabled.load(std::memory_order_relaxed);
+}
+
+void enable(bool on = true);
+// Records per thread, applies to threads recording for the first time.
+// A buffer takes capacity * sizeof(Record) bytes (2.5 MiB by default on 64-bit
+// platforms) from the first record of its thread, and is kept after the thread
+// exits until clear()
+void set_buffer_capacity(size_t records);
+// Clears recorded data and releases the buffers of exited threads,
+// should not be called while tracing
+void clear();
+// Buffers held: one per thread that recorded, including exited ones until clear()
+[[nodiscard]] size_t buffers_count();
+// Number of records dropped because of full buffers
+[[nodiscard]] uint64_t dropped();
+
+// Stable copy of the name for records
+const char* intern(std::string_view name);
+
+void record(Phase phase, const char* name, uint64_t event = 0, uint64_t flow = 0);
+// Event being processed by this thread, 0 if none
+[[nodiscard]] uint64_t current_event();
+
+void write_chrome_json(std::ostream& out);
+void save_chrome_json(const std::string& path);
+
+// Sets the current event of the thread: a new one for emissions outside
+// of other events' processing, or the given one (tasks on executors)
+class EventScope {
+public:
+    EventScope();
+    explicit EventScope(uint64_t event);
+    ~EventScope();
+    EventScope(const EventScope&) = delete;
+    EventScope& operator=(const EventScope&) = delete;
+
+private:
+    bool active_ = false;
+    uint64_t previous_ = 0;
+};
+
+// Callback entry / exit
+class Span {
+public:
+    explicit Span(const char* name)
+        : name_{ enabled() ? name : nullptr } {
+        if (name_)
+            record(Phase::Begin, name_, current_event());
+    }
+
+    ~Span() {
+        if (name_)
+            record(Phase::End, name_, current_event());
+    }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    const char* name_;
+};
+
+// Wraps an executor task to record enqueue / dequeue and the callback
+std::function<void()> traced(const char* name, std::function<void()> task);
+
+} // namespace tiny_rx::trace
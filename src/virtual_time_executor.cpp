@@ -0,0 +1,71 @@
+#include "virtual_time_executor.h"
+
+#include "log.h"
+
+namespace tiny_rx {
+
+void VirtualTimeExecutor::add_task(std::function<void()> f) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push(Task{ now_, next_seq_++, std::move(f) });
+}
+
+void VirtualTimeExecutor::add_task_at(TimePoint time, std::function<void()> f) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Tasks in the past are due now
+    tasks_.push(Task{ std::max(time, now_), next_seq_++, std::move(f) });
+}
+
+void VirtualTimeExecutor::add_task_after(Duration delay, std::function<void()> f) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push(Task{ now_ + std::max(delay, Duration::zero()), next_seq_++, std::move(f) });
+}
+
+VirtualTimeExecutor::TimePoint VirtualTimeExecutor::now() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return now_;
+}
+
+size_t VirtualTimeExecutor::advance_to(TimePoint time) {
+    size_t executed = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!tasks_.empty() && tasks_.top().time <= time) {
+        // priority_queue::top() is const: the task is moved out through const_cast before pop(),
+        // which only compares the time and sequence fields left intact by the move
+        auto task = std::move(const_cast<Task&>(tasks_.top()));
+        tasks_.pop();
+        now_ = task.time;
+        lock.unlock();
+
+        try {
+            task.func();
+        } catch (const std::exception& e) {
+            log(utils::LogSeverity::Error, "VirtualTimeExecutor exception on task: ", e.what());
+        }
+        ++executed;
+        lock.lock();
+    }
+    now_ = std::max(now_, time);
+    return executed;
+}
+
+size_t VirtualTimeExecutor::advance_by(Duration duration) {
+    return advance_to(now() + duration);
+}
+
+size_t VirtualTimeExecutor::run_pending() {
+    return advance_to(now());
+}
+
+size_t VirtualTimeExecutor::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tasks_.size();
+}
+
+std::optional<VirtualTimeExecutor::TimePoint> VirtualTimeExecutor::next_due() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (tasks_.empty())
+        return std::nullopt;
+    return tasks_.top().time;
+}
+
+} // namespace tiny_rx
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "iexecutor.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <vector>
+
+namespace tiny_rx {
+
+// Clock of VirtualTimeExecutor: time starts at zero and moves only when advanced
+struct VirtualClock {
+    using duration = std::chrono::nanoseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<VirtualClock>;
+    static constexpr bool is_steady = true;
+};
+
+// Executor with programmatically advanced time, for deterministic tests and simulations
+// of time-based pipelines. Tasks run on the thread calling advance_by() / advance_to()
+// in the order of their due time (tasks with the same due time - in the order added),
+// now() returns the due time of the running task. Hours of virtual time pass instantly.
+// Tasks may be added from any thread
+class VirtualTimeExecutor : public IExecutor {
+public:
+    using TimePoint = VirtualClock::time_point;
+    using Duration = VirtualClock::duration;
+
+    VirtualTimeExecutor() = default;
+    VirtualTimeExecutor(const VirtualTimeExecutor&) = delete;
+    VirtualTimeExecutor(VirtualTimeExecutor&&) = delete;
+    VirtualTimeExecutor& operator=(const VirtualTimeExecutor&) = delete;
+    VirtualTimeExecutor& operator=(VirtualTimeExecutor&&) = delete;
+
+    // Task due now
+    void add_task(std::function<void()> f) override;
+    void add_task_at(TimePoint time, std::function<void()> f);
+    void add_task_after(Duration delay, std::function<void()> f);
+    [[nodiscard]] bool is_serial() const override { return true; }
+
+    [[nodiscard]] TimePoint now() const;
+
+    // Run all tasks due up to the time (including added by running tasks),
+    // return the number of tasks executed
+    size_t advance_to(TimePoint time);
+    size_t advance_by(Duration duration);
+    // Tasks due now
+    size_t run_pending();
+
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] std::optional<TimePoint> next_due() const;
+
+private:
+    struct Task {
+        TimePoint time;
+        uint64_t seq;
+        std::function<void()> func;
+    };
+
+    struct Later {
+        bool operator()(const Task& lhs, const Task& rhs) const {
+            return lhs.time != rhs.time ? lhs.time > rhs.time : lhs.seq > rhs.seq;
+        }
+    };
+
+    std::priority_queue<Task, std::vector<Task>, Later> tasks_;
+    TimePoint now_{};
+    uint64_t next_seq_ = 0;
+    mutable std::mutex mutex_;
+};
+
+} // namespace tiny_rx
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+
+namespace tiny_rx {
+
+struct JoinParams {
+    // Values kept per side, the oldest are evicted beyond it (before they expire)
+    size_t max_entries = 65536;
+    // Time source, e.g. [&executor]() { return executor.now().time_since_epoch(); }
+    // for VirtualTimeExecutor. steady_clock if empty
+    std::function<std::chrono::nanoseconds()> now;
+};
+
+// One side of a windowed join: values in arrival order, indexed by key.
+// Entries live in a FIFO, every key maps to the chain of its entries (linked by
+// sequence numbers), so expiring the oldest entry and probing a key take O(1)
+// expected time (plus the number of matches)
+template<typename K, typename V>
+class WindowJoinIndex {
+public:
+    using Time = std::chrono::nanoseconds;
+
+    explicit WindowJoinIndex(size_t max_entries)
+        : max_entries_{ max_entries } {
+    }
+
+    void insert(Time time, const K& key, const V& value) {
+        if (entries_.size() >= max_entries_)
+            pop_front();
+
+        const auto seq = front_seq_ + entries_.size();
+        entries_.push_back(Entry{ time, key, value, kNone });
+        auto [chain, inserted] = index_.try_emplace(key, Chain{ seq, seq });
+        if (!inserted) {
+            at(chain->second.last).next = seq;
+            chain->second.last = seq;
+        }
+    }
+
+    // Removes entries arrived before the time
+    void evict_before(Time time) {
+        while (!entries_.empty() && entries_.front().time < time)
+            pop_front();
+    }
+
+    // Calls func(value) for entries with the key, oldest first
+    template<typename F>
+    void for_each(const K& key, F&& func) const {
+        const auto chain = index_.find(key);
+        if (chain == index_.end())
+            return;
+        for (auto seq = chain->second.first; seq != kNone; seq = at(seq).next)
+            func(at(seq).value);
+    }
+
+    [[nodiscard]] size_t size() const {
+        return entries_.size();
+    }
+
+    [[nodiscard]] size_t keys() const {
+        return index_.size();
+    }
+
+private:
+    static constexpr uint64_t kNone = std::numeric_limits<uint64_t>::max();
+
+    struct Entry {
+        Time time;
+        K key;
+        V value;
+        // Next entry with the same key
+        uint64_t next;
+    };
+
+    struct Chain {
+        uint64_t first;
+        uint64_t last;
+    };
+
+    Entry& at(uint64_t seq) {
+        return entries_[static_cast<size_t>(seq - front_seq_)];
+    }
+
+    const Entry& at(uint64_t seq) const {
+        return entries_[static_cast<size_t>(seq - front_seq_)];
+    }
+
+    // The oldest entry is the first one of its key
+    void pop_front() {
+        const auto& entry = entries_.front();
+        const auto chain = index_.find(entry.key);
+        if (entry.next == kNone)
+            index_.erase(chain);
+        else
+            chain->second.first = entry.next;
+        entries_.pop_front();
+        ++front_seq_;
+    }
+
+    size_t max_entries_;
+    std::deque<Entry> entries_;
+    uint64_t front_seq_ = 0;
+    std::unordered_map<K, Chain> index_;
+};
+
+} // namespace tiny_rx
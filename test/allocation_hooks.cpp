@@ -0,0 +1,150 @@
+#include "tiny_rx.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+// Runs as a separate executable: it links the global operator new replacement
+// (tiny_rx_allocation_hooks), which the other tests should not depend on
+
+TEST(Allocation_Hooks, No_Allocations_Per_Event) {
+    ASSERT_TRUE(tiny_rx::alloc::hooks_installed());
+
+    tiny_rx::Observable<int> observable;
+    int sum = 0;
+    auto subscription = observable.map([](int v) {
+        return v * 2;
+    }).filter([](int v) {
+        return v % 3 != 0;
+    }).subscribe([&sum](int v) {
+        sum += v;
+    });
+
+    tiny_rx::alloc::AllocationMeter meter;
+    {
+        tiny_rx::alloc::HotPathGuard hot_path("map / filter");
+        for (int v = 0; v < 1000; ++v) {
+            observable.next(v);
+        }
+    }
+    EXPECT_EQ(0u, meter.allocations());
+    EXPECT_NE(0, sum);
+}
+
+namespace {
+std::vector<size_t> violations;
+}
+
+TEST(Allocation_Hooks, Hot_Path_Violation) {
+    ASSERT_TRUE(tiny_rx::alloc::hooks_installed());
+    violations.reserve(16);
+    tiny_rx::alloc::set_violation_handler([](const char*, size_t size) { violations.push_back(size); });
+
+    tiny_rx::Observable<std::string> observable;
+    std::vector<std::string> results;
+    results.reserve(16);
+    auto subscription = observable.subscribe([&results](const std::string& s) {
+        results.push_back(s);
+    });
+
+    const std::string long_value(100, 'x');
+    {
+        tiny_rx::alloc::HotPathGuard hot_path("strings");
+        observable.next(long_value);
+    }
+    observable.next(long_value);
+    tiny_rx::alloc::set_violation_handler(nullptr);
+
+    EXPECT_EQ(2u, results.size());
+    ASSERT_FALSE(violations.empty());
+    EXPECT_EQ(long_value.size() + 1, violations.back());
+}
+
+TEST(Allocation_Hooks, Introspection_Counts_Allocations) {
+    tiny_rx::introspection::enable();
+    {
+        tiny_rx::Observable<int> observable;
+        auto run_loop = std::make_shared<tiny_rx::RunLoopExecutor>();
+
+        std::vector<int> results;
+        auto subscription = observable.filter([](int v) {
+            return v % 2 == 0;
+        }).subscribe_on(run_loop).subscribe([&results](int v) {
+            results.push_back(v);
+        });
+
+        for (int v = 0; v < 10; ++v) {
+            observable.next(v);
+        }
+        while (run_loop->size() != 0) {
+            run_loop->dispatch();
+        }
+        EXPECT_EQ(5u, results.size());
+
+        auto nodes = tiny_rx::introspection::snapshot();
+        const auto filter_node = std::find_if(nodes.begin(), nodes.end(), [](const auto& node) {
+            return node.kind == "filter";
+        });
+        ASSERT_NE(nodes.end(), filter_node);
+        // Tasks queued to the run loop are heap allocated
+        EXPECT_LE(5u, filter_node->allocations);
+    }
+    tiny_rx::introspection::enable(false);
+}
+
+TEST(Allocation_Hooks, Pipeline_From_Memory_Resource) {
+    ASSERT_TRUE(tiny_rx::alloc::hooks_installed());
+    // Runs out of memory rather than falling back to the global heap
+    alignas(std::max_align_t) char buffer[64 * 1024];
+    std::pmr::monotonic_buffer_resource pool(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+
+    std::vector<int> results;
+    results.reserve(4);
+    {
+        tiny_rx::ScopedMemoryResource scope(&pool);
+        tiny_rx::Observable<int> observable;
+
+        tiny_rx::alloc::AllocationMeter meter;
+        auto subscription = observable.map([](int v) {
+            return v * 3;
+        }).filter([](int v) {
+            return v % 2 == 0;
+        }).subscribe([&results](int v) {
+            results.push_back(v);
+        });
+        // Only closures that don't fit into std::function (it has no allocator support):
+        // the subscriber and demand callbacks of map and filter, and the final subscriber
+        EXPECT_GE(5u, meter.allocations());
+
+        for (int v = 1; v <= 4; ++v) {
+            observable.next(v);
+        }
+        subscription.unsubscribe();
+    }
+    EXPECT_EQ((std::vector<int>{ 6, 12 }), results);
+}
+
+TEST(Allocation_Hooks, DDSketch_Collapsed_Store) {
+    ASSERT_TRUE(tiny_rx::alloc::hooks_installed());
+    tiny_rx::DDSketch sketch(0.01, 64);
+    for (int i = 0; i < 64; ++i) {
+        sketch.add(1000.0 * std::pow(1.02, i));
+    }
+    // Collapses the lowest buckets: the store is full from now on
+    sketch.add(1.0);
+
+    // Lower values land in the lowest bucket without rebuilding the store
+    tiny_rx::alloc::AllocationMeter meter;
+    for (int i = 1; i <= 1000; ++i) {
+        sketch.add(1.0 / i);
+    }
+    EXPECT_EQ(0u, meter.allocations());
+
+    EXPECT_EQ(1065u, sketch.count());
+    EXPECT_NEAR(1000.0 * std::pow(1.02, 63), sketch.quantile(1), 1000.0 * std::pow(1.02, 63) * 0.01);
+}
@@ -0,0 +1,174 @@
+#include "tiny_rx.h"
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+template<typename T>
+std::vector<T> random_values(size_t count) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> dist(-1000, 1000);
+    std::vector<T> values(count);
+    for (auto& v : values) {
+        v = static_cast<T>(dist(rng));
+    }
+    return values;
+}
+
+// Runs func for every instruction set supported by the CPU, restores default afterwards
+template<typename F>
+void for_each_isa(F func) {
+    using tiny_rx::batch::Isa;
+    for (auto isa : { Isa::Scalar, Isa::Sse, Isa::Avx2 }) {
+        if (static_cast<int>(isa) > static_cast<int>(tiny_rx::batch::detected_isa()))
+            continue;
+        tiny_rx::batch::set_active_isa(isa);
+        func();
+    }
+    tiny_rx::batch::set_active_isa(tiny_rx::batch::detected_isa());
+}
+
+template<typename T>
+void check_kernels() {
+    using namespace tiny_rx::batch;
+    // Odd size to cover both vector and tail loops
+    const auto values = random_values<T>(1037);
+
+    std::vector<T> multiply_add_etalon;
+    std::vector<T> greater_etalon;
+    std::vector<uint32_t> less_indices_etalon;
+    T min_etalon = values.front();
+    T max_etalon = values.front();
+    T sum_etalon{};
+    for (const auto& v : values) {
+        multiply_add_etalon.push_back(v * T(3) + T(7));
+        if (v > T(100))
+            greater_etalon.push_back(v);
+        if (v < T(-100))
+            less_indices_etalon.push_back(static_cast<uint32_t>(&v - values.data()));
+        min_etalon = std::min(min_etalon, v);
+        max_etalon = std::max(max_etalon, v);
+        sum_etalon += v;
+    }
+
+    for_each_isa([&]() {
+        std::vector<T> out(values.size());
+        multiply_add(values.data(), out.data(), values.size(), T(3), T(7));
+        EXPECT_EQ(multiply_add_etalon, out);
+
+        out.resize(select_greater(values.data(), out.data(), values.size(), T(100)));
+        EXPECT_EQ(greater_etalon, out);
+
+        std::vector<uint32_t> indices(values.size());
+        indices.resize(select_less_indices(values.data(), values.size(), T(-100), indices.data()));
+        EXPECT_EQ(less_indices_etalon, indices);
+
+        EXPECT_EQ(min_etalon, reduce(values.data(), values.size(), Reduction::Min));
+        EXPECT_EQ(max_etalon, reduce(values.data(), values.size(), Reduction::Max));
+        // Small integer values are summed exactly with floating point types as well
+        EXPECT_EQ(sum_etalon, reduce(values.data(), values.size(), Reduction::Sum));
+    });
+}
+
+}
+
+TEST(Batch_Kernels, Int_Kernels) {
+    check_kernels<int>();
+}
+
+TEST(Batch_Kernels, Float_Kernels) {
+    check_kernels<float>();
+}
+
+TEST(Batch_Kernels, Double_Kernels) {
+    check_kernels<double>();
+}
+
+template<typename T>
+void check_infinite_reduce() {
+    using namespace tiny_rx::batch;
+    const auto inf = std::numeric_limits<T>::infinity();
+    // Longer than the vector width to cover both vector and tail loops
+    const std::vector<T> positive(19, inf);
+    const std::vector<T> negative(19, -inf);
+
+    for_each_isa([&]() {
+        EXPECT_EQ(inf, reduce(positive.data(), positive.size(), Reduction::Min));
+        EXPECT_EQ(-inf, reduce(negative.data(), negative.size(), Reduction::Max));
+        EXPECT_EQ(inf, reduce(positive.data(), 1, Reduction::Min));
+        EXPECT_EQ(-inf, reduce(negative.data(), 1, Reduction::Max));
+    });
+}
+
+TEST(Batch_Kernels, Infinite_Min_Max) {
+    check_infinite_reduce<float>();
+    check_infinite_reduce<double>();
+}
+
+TEST(Batch_Kernels, Observable_Batches) {
+    tiny_rx::Observable<int> observable;
+
+    const std::vector<std::vector<int>> etalon{ { 12 }, { 14, 16, 18, 20 } };
+    std::vector<std::vector<int>> results;
+    int sum = 0;
+
+    auto& batches = observable.buffer(4);
+
+    auto subscription = batches
+        .map(tiny_rx::batch::ops::multiply(2))
+        .map(tiny_rx::batch::ops::select_greater(10))
+        .subscribe([&results](const std::vector<int>& values) {
+            results.push_back(values);
+        });
+
+    auto sum_subscription = batches
+        .reduce_batch(tiny_rx::batch::Reduction::Sum)
+        .subscribe([&sum](int value) {
+            sum = value;
+        });
+
+    for (int v = 3; v <= 10; ++v) {
+        observable.next(v);
+    }
+    observable.end();
+
+    EXPECT_EQ(etalon, results);
+    EXPECT_EQ(3 + 4 + 5 + 6 + 7 + 8 + 9 + 10, sum);
+}
+
+TEST(Batch_Kernels, Columnar_Batches) {
+    tiny_rx::Observable<int, double, std::string> observable;
+
+    using Batch = tiny_rx::ColumnarBatch<int, double, std::string>;
+    std::vector<Batch> results;
+    double sum = 0.0;
+
+    auto& batches = observable.buffer_columnar(4);
+
+    auto subscription = batches
+        .map(tiny_rx::batch::ops::select_column_greater<0>(2))
+        .subscribe([&results](const Batch& values) {
+            results.push_back(values);
+        });
+
+    auto sum_subscription = batches
+        .reduce_column<1>(tiny_rx::batch::Reduction::Sum)
+        .subscribe([&sum](double value) {
+            sum = value;
+        });
+
+    for (int v = 1; v <= 6; ++v) {
+        observable.next(v, v * 0.5, std::to_string(v));
+    }
+    observable.end();
+
+    ASSERT_EQ(2u, results.size());
+    EXPECT_EQ((std::vector<int>{ 3, 4 }), results[0].column<0>());
+    EXPECT_EQ((std::vector<std::string>{ "3", "4" }), results[0].column<2>());
+    EXPECT_EQ((std::tuple<int, double, std::string>{ 6, 3.0, "6" }), results[1].row(1));
+    EXPECT_DOUBLE_EQ(0.5 * (1 + 2 + 3 + 4 + 5 + 6), sum);
+}
@@ -2,6 +2,13 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory_resource>
+#include <sstream>
+#include <thread>
+
 TEST(Observable_Complex_Subscription, Check_Map_Filter) {
     tiny_rx::Observable<int> observable;
 
@@ -118,3 +125,447 @@ TEST(Observable_Complex_Subscription, Check_Map_Subscribe_Unsubscribe_Map_Not_Re
 
     EXPECT_EQ(etalon_map, results);
 }
+
+TEST(Observable_Complex_Subscription, Share_Runs_Stage_Once) {
+    tiny_rx::Observable<int> observable;
+
+    int map_calls = 0;
+    auto shared = observable.map([&map_calls](int v) {
+        ++map_calls;
+        return v * 2;
+    }).share();
+    EXPECT_EQ(1u, observable.subscribers_count());
+    EXPECT_FALSE(shared->is_connected());
+
+    std::vector<int> doubled;
+    std::vector<int> tripled;
+    auto double_subscription = shared->subscribe([&doubled](int v) {
+        doubled.push_back(v);
+    });
+    auto triple_subscription = shared->map([](int v) {
+        return v * 3;
+    }).subscribe([&tripled](int v) {
+        tripled.push_back(v);
+    });
+    EXPECT_TRUE(shared->is_connected());
+
+    for (int v = 1; v <= 4; ++v) {
+        observable.next(v);
+    }
+
+    EXPECT_EQ(4, map_calls);
+    EXPECT_EQ((std::vector<int>{ 2, 4, 6, 8 }), doubled);
+    EXPECT_EQ((std::vector<int>{ 6, 12, 18, 24 }), tripled);
+
+    // The map() stage is removed with the last subscriber
+    double_subscription.unsubscribe();
+    EXPECT_EQ(1u, observable.subscribers_count());
+    triple_subscription.unsubscribe();
+    EXPECT_FALSE(shared->is_connected());
+    EXPECT_EQ(0u, observable.subscribers_count());
+    EXPECT_FALSE(shared->connect());
+}
+
+TEST(Observable_Complex_Subscription, Share_Reconnects_To_Source) {
+    tiny_rx::Observable<int> observable;
+    auto shared = observable.share();
+
+    std::vector<int> results;
+    auto subscription = shared->subscribe([&results](int v) {
+        results.push_back(v);
+    });
+    observable.next(1);
+    subscription.unsubscribe();
+    EXPECT_EQ(0u, observable.subscribers_count());
+    observable.next(2);
+
+    subscription = shared->subscribe([&results](int v) {
+        results.push_back(v);
+    });
+    observable.next(3);
+
+    EXPECT_EQ((std::vector<int>{ 1, 3 }), results);
+}
+
+TEST(Observable_Complex_Subscription, Publish_Connect) {
+    tiny_rx::Observable<int> observable;
+    auto published = observable.publish();
+
+    std::vector<int> first;
+    std::vector<int> second;
+    auto first_subscription = published->subscribe([&first](int v) {
+        first.push_back(v);
+    });
+    observable.next(1);
+    EXPECT_EQ(0u, observable.subscribers_count());
+
+    auto second_subscription = published->subscribe([&second](int v) {
+        second.push_back(v);
+    });
+    published->connect();
+    observable.next(2);
+
+    published->disconnect();
+    observable.next(3);
+
+    EXPECT_EQ((std::vector<int>{ 2 }), first);
+    EXPECT_EQ((std::vector<int>{ 2 }), second);
+}
+
+TEST(Observable_Complex_Subscription, Publish_After_Source_Destroyed) {
+    std::shared_ptr<tiny_rx::ConnectableObservable<int>> published;
+    std::shared_ptr<tiny_rx::ConnectableObservable<int>> shared;
+    {
+        tiny_rx::Observable<int> observable;
+        published = observable.publish();
+        shared = observable.share();
+    }
+    EXPECT_FALSE(published->connect());
+
+    // Auto-connect on the first subscriber doesn't reach the destroyed source either
+    int received = 0;
+    auto subscription = shared->subscribe([&received](int) { ++received; });
+    EXPECT_FALSE(shared->is_connected());
+    EXPECT_EQ(0, received);
+}
+
+TEST(Observable_Complex_Subscription, Chains_Freed_After_Unsubscribe) {
+    tiny_rx::Observable<int> observable;
+    const auto live_before = tiny_rx::live_observables();
+
+    int results = 0;
+    for (int i = 0; i < 1000; ++i) {
+        auto subscription = observable.map([](int v) {
+            return v * 3;
+        }).filter([](int v) {
+            return v % 2 == 0;
+        }).map([](int v) {
+            return v + 1;
+        }).subscribe([&results](int) {
+            ++results;
+        });
+        EXPECT_EQ(live_before + 3, tiny_rx::live_observables());
+
+        observable.next(i);
+        subscription.unsubscribe();
+        EXPECT_EQ(0u, observable.subscribers_count());
+        EXPECT_EQ(live_before, tiny_rx::live_observables());
+    }
+    EXPECT_EQ(500, results);
+}
+
+TEST(Observable_Complex_Subscription, Unsubscribe_From_On_Next) {
+    tiny_rx::Observable<int> observable;
+    const auto live_before = tiny_rx::live_observables();
+
+    std::vector<int> results;
+    std::vector<int> other_results;
+    tiny_rx::Subscription subscription;
+    subscription = observable.map([](int v) {
+        return v * 2;
+    }).subscribe([&results, &subscription](int v) {
+        results.push_back(v);
+        if (v == 4)
+            subscription.unsubscribe();
+    });
+    auto other_subscription = observable.subscribe([&other_results](int v) {
+        other_results.push_back(v);
+    });
+
+    for (int v = 1; v <= 4; ++v) {
+        observable.next(v);
+    }
+
+    EXPECT_EQ((std::vector<int>{ 2, 4 }), results);
+    EXPECT_EQ((std::vector<int>{ 1, 2, 3, 4 }), other_results);
+    EXPECT_EQ(1u, observable.subscribers_count());
+    EXPECT_EQ(live_before, tiny_rx::live_observables());
+}
+
+namespace {
+
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t allocations = 0;
+    size_t deallocations = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        ++deallocations;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+} // namespace
+
+TEST(Observable_Complex_Subscription, Memory_Resource) {
+    CountingResource resource;
+    std::vector<int> results;
+    {
+        tiny_rx::ScopedMemoryResource scope(&resource);
+        tiny_rx::Observable<int> observable;
+        EXPECT_EQ(&resource, observable.get_memory_resource());
+
+        auto subscription = observable.map([](int v) {
+            return v * 3;
+        }).filter([](int v) {
+            return v % 2 == 0;
+        }).subscribe([&results](int v) {
+            results.push_back(v);
+        });
+        // Subscriber and subscription entries, subscription flags, proxy observables
+        EXPECT_GE(resource.allocations, 8u);
+
+        for (int v = 1; v <= 4; ++v) {
+            observable.next(v);
+        }
+        subscription.unsubscribe();
+    }
+    EXPECT_EQ(tiny_rx::current_memory_resource(), std::pmr::get_default_resource());
+    EXPECT_EQ((std::vector<int>{ 6, 12 }), results);
+    EXPECT_EQ(resource.allocations, resource.deallocations);
+}
+
+TEST(Observable_Complex_Subscription, Introspection_Counters) {
+    tiny_rx::introspection::enable();
+    const auto nodes_before = tiny_rx::introspection::nodes_count();
+    {
+        tiny_rx::Observable<int> observable;
+        auto run_loop = std::make_shared<tiny_rx::RunLoopExecutor>();
+
+        std::vector<int> results;
+        auto subscription = observable.map([](int v) {
+            return v * 3;
+        }).filter([](int v) {
+            return v % 2 == 0;
+        }).subscribe_on(run_loop).named("results").subscribe([&results](int v) {
+            results.push_back(v);
+        });
+        // A stored intermediate observable without subscribers
+        auto& unused = observable.map([](int v) { return v; });
+        (void)unused;
+
+        for (int v = 0; v < 10; ++v) {
+            observable.next(v);
+        }
+        while (run_loop->size() != 0) {
+            run_loop->dispatch();
+        }
+        EXPECT_EQ(5u, results.size());
+
+        auto nodes = tiny_rx::introspection::snapshot();
+        EXPECT_EQ(nodes_before + 4, tiny_rx::introspection::nodes_count());
+        auto find = [&nodes](const std::string& kind) {
+            return std::find_if(nodes.begin(), nodes.end(), [&kind](const auto& node) { return node.kind == kind; });
+        };
+        const auto map_node = find("map");
+        const auto filter_node = find("filter");
+        ASSERT_NE(nodes.end(), map_node);
+        ASSERT_NE(nodes.end(), filter_node);
+        EXPECT_EQ(10u, map_node->events_in);
+        EXPECT_EQ(10u, map_node->events_out);
+        EXPECT_EQ(10u, filter_node->events_in);
+        EXPECT_EQ(5u, filter_node->events_out);
+        // Allocations are counted only with tiny_rx_allocation_hooks linked (see allocation_hooks.cpp)
+        EXPECT_EQ(0u, filter_node->allocations);
+        EXPECT_EQ(map_node->id, filter_node->upstream);
+        ASSERT_EQ(1u, filter_node->subscribers.size());
+        EXPECT_EQ("results", filter_node->subscribers[0].name);
+        EXPECT_EQ("executor", filter_node->subscribers[0].executor);
+        EXPECT_EQ(run_loop.get(), filter_node->subscribers[0].executor_address);
+
+        std::ostringstream dot;
+        tiny_rx::introspection::write_dot(dot);
+        EXPECT_NE(std::string::npos, dot.str().find("filter #"));
+        EXPECT_NE(std::string::npos, dot.str().find("color=red"));
+
+        std::ostringstream json;
+        tiny_rx::introspection::write_json(json);
+        EXPECT_NE(std::string::npos, json.str().find("\"kind\":\"filter\""));
+
+        subscription.unsubscribe();
+        EXPECT_EQ(nodes_before + 2, tiny_rx::introspection::nodes_count());
+    }
+    EXPECT_EQ(nodes_before, tiny_rx::introspection::nodes_count());
+    tiny_rx::introspection::enable(false);
+}
+
+TEST(Observable_Complex_Subscription, Introspection_Escapes_Names) {
+    tiny_rx::introspection::enable();
+    {
+        tiny_rx::Observable<int> observable;
+        auto subscription = observable.map([](int v) {
+            return v;
+        }).named("line\nbreak\t\"quoted\"").subscribe([](int) {});
+
+        std::ostringstream json;
+        tiny_rx::introspection::write_json(json);
+        EXPECT_NE(std::string::npos, json.str().find("line\\u000abreak\\u0009\\\"quoted\\\""));
+        EXPECT_EQ(std::string::npos, json.str().find('\t'));
+
+        std::ostringstream dot;
+        tiny_rx::introspection::write_dot(dot);
+        EXPECT_NE(std::string::npos, dot.str().find("line\\u000abreak"));
+    }
+    tiny_rx::introspection::enable(false);
+}
+
+TEST(Observable_Complex_Subscription, Combine_Zip_Latest) {
+    tiny_rx::Observable<int> numbers;
+    tiny_rx::Observable<std::string> names;
+
+    std::vector<std::string> zipped;
+    bool zip_ended = false;
+    auto zip_subscription = numbers.zip(names).subscribe([&zipped](int v, const std::string& s) {
+        zipped.push_back(std::to_string(v) + s);
+    }, [&zip_ended]() { zip_ended = true; });
+
+    std::vector<std::string> latest;
+    auto latest_subscription = numbers.combine_latest(names).subscribe([&latest](int v, const std::string& s) {
+        latest.push_back(std::to_string(v) + s);
+    });
+
+    std::vector<std::string> sampled;
+    auto sampled_subscription = numbers.with_latest_from(names).subscribe([&sampled](int v, const std::string& s) {
+        sampled.push_back(std::to_string(v) + s);
+    });
+
+    numbers.next(1);
+    numbers.next(2);
+    names.next("a");
+    numbers.next(3);
+    names.next("b");
+    names.next("c");
+    names.end();
+
+    EXPECT_EQ(std::vector<std::string>({ "1a", "2b", "3c" }), zipped);
+    EXPECT_TRUE(zip_ended);
+    EXPECT_EQ(std::vector<std::string>({ "2a", "3a", "3b", "3c" }), latest);
+    EXPECT_EQ(std::vector<std::string>({ "3a" }), sampled);
+}
+
+TEST(Observable_Complex_Subscription, Merge_From_Threads) {
+    const auto live_before = tiny_rx::live_observables();
+    {
+        tiny_rx::Observable<int> first;
+        tiny_rx::Observable<int> second;
+
+        constexpr int count = 20000;
+        std::atomic<bool> in_callback{ false };
+        bool overlapped = false;
+        int64_t sum = 0;
+        int ended = 0;
+        auto subscription = first.merge(second).subscribe([&](int v) {
+            if (in_callback.exchange(true))
+                overlapped = true;
+            sum += v;
+            in_callback = false;
+        }, [&ended]() { ++ended; });
+
+        auto emit = [](tiny_rx::Observable<int>& observable) {
+            for (int v = 1; v <= count; ++v) {
+                observable.next(v);
+            }
+            observable.end();
+        };
+        std::thread first_thread(emit, std::ref(first));
+        std::thread second_thread(emit, std::ref(second));
+        first_thread.join();
+        second_thread.join();
+
+        EXPECT_FALSE(overlapped);
+        EXPECT_EQ(2 * static_cast<int64_t>(count) * (count + 1) / 2, sum);
+        EXPECT_EQ(1, ended);
+
+        subscription.unsubscribe();
+        EXPECT_EQ(0u, first.subscribers_count());
+        EXPECT_EQ(0u, second.subscribers_count());
+    }
+    EXPECT_EQ(live_before, tiny_rx::live_observables());
+}
+
+TEST(Observable_Complex_Subscription, Serialized_Drain_Producer_Order) {
+    constexpr int producers = 16;
+    constexpr int count = 50000;
+    std::vector<int> last(producers, -1);
+    bool reordered = false;
+    int handled = 0;
+    {
+        tiny_rx::SerializedDrain<std::pair<int, int>> drain([&](std::pair<int, int>& event) {
+            if (event.second != last[event.first] + 1)
+                reordered = true;
+            last[event.first] = event.second;
+            ++handled;
+        });
+
+        std::vector<std::thread> threads;
+        for (int producer = 0; producer < producers; ++producer) {
+            threads.emplace_back([&drain, producer]() {
+                for (int seq = 0; seq < count; ++seq) {
+                    drain.push({ producer, seq });
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    EXPECT_FALSE(reordered);
+    EXPECT_EQ(producers * count, handled);
+}
+
+namespace {
+struct Fill {
+    int order_id;
+    int quantity;
+};
+}
+
+TEST(Observable_Complex_Subscription, Window_Join) {
+    tiny_rx::Observable<int> orders;
+    tiny_rx::Observable<Fill> fills;
+
+    std::chrono::nanoseconds now{ 0 };
+    tiny_rx::JoinParams params;
+    params.max_entries = 4;
+    params.now = [&now]() { return now; };
+
+    std::vector<std::pair<int, int>> results;
+    bool ended = false;
+    auto subscription = orders.join(fills, [](int id) { return id; }, [](const Fill& fill) { return fill.order_id; },
+        std::chrono::seconds(10), params).subscribe([&results](int id, const Fill& fill) {
+        results.emplace_back(id, fill.quantity);
+    }, [&ended]() { ended = true; });
+
+    orders.next(1);
+    orders.next(2);
+    fills.next(Fill{ 1, 10 });
+    fills.next(Fill{ 3, 30 });
+    orders.next(3);
+    fills.next(Fill{ 1, 11 });
+    // Order 2 expires
+    now = std::chrono::seconds(11);
+    fills.next(Fill{ 2, 20 });
+    orders.next(1);
+    // Only 4 orders are kept: order 1 is evicted before it expires
+    for (int id = 10; id < 14; ++id) {
+        orders.next(id);
+    }
+    fills.next(Fill{ 1, 12 });
+    orders.end();
+    EXPECT_FALSE(ended);
+    fills.end();
+    EXPECT_TRUE(ended);
+
+    const std::vector<std::pair<int, int>> etalon{ { 1, 10 }, { 3, 30 }, { 1, 11 } };
+    EXPECT_EQ(etalon, results);
+}
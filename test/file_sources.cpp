@@ -0,0 +1,300 @@
+#include "tiny_rx.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Point {
+    int x;
+    int y;
+};
+
+class TempFile {
+public:
+    explicit TempFile(const std::string& content) {
+        path_ = (std::filesystem::temp_directory_path() / ("tiny_rx_" + tiny_rx::Guid().to_string())).string();
+        std::ofstream out(path_, std::ios::binary);
+        out << content;
+    }
+    ~TempFile() {
+        std::remove(path_.c_str());
+    }
+    [[nodiscard]] const std::string& path() const {
+        return path_;
+    }
+private:
+    std::string path_;
+};
+
+std::vector<std::string> collect(tiny_rx::MappedFileSource& source) {
+    tiny_rx::Observable<std::string_view> observable;
+    std::vector<std::string> results;
+    auto subscription = observable.subscribe([&results](std::string_view record) {
+        results.emplace_back(record);
+    });
+    source.emit(observable);
+    return results;
+}
+
+}
+
+template<>
+struct tiny_rx::is_bitwise_recordable<Point> : std::true_type {};
+
+TEST(Observable_File_Sources, Mapped_File_Newline_Delimited) {
+    const TempFile file("first\nsecond\n\nlast");
+    tiny_rx::MappedFileSource source(file.path());
+
+    const std::vector<std::string> etalon{ "first", "second", "", "last" };
+    EXPECT_EQ(etalon, collect(source));
+}
+
+TEST(Observable_File_Sources, Mapped_File_Length_Prefixed) {
+    std::string content;
+    const std::vector<std::string> etalon{ "abc", "", "0123456789" };
+    for (const auto& record : etalon) {
+        const auto size = static_cast<uint32_t>(record.size());
+        for (int i = 0; i < 4; ++i) {
+            content.push_back(static_cast<char>((size >> (i * 8)) & 0xFF));
+        }
+        content += record;
+    }
+    const TempFile file(content);
+    tiny_rx::MappedFileSource source(file.path(), { tiny_rx::RecordFraming::LengthPrefixed });
+
+    EXPECT_EQ(etalon, collect(source));
+}
+
+TEST(Observable_File_Sources, Mapped_File_Truncated_Record) {
+    // "abc", then a record of 10 bytes with only 2 of them present
+    const TempFile file(std::string("\x03\0\0\0abc\x0a\0\0\0de", 13));
+    tiny_rx::MappedFileSource source(file.path(), { tiny_rx::RecordFraming::LengthPrefixed });
+
+    tiny_rx::Observable<std::string_view> observable;
+    std::vector<std::string> results;
+    std::vector<std::string> errors;
+    int on_end_call_times = 0;
+    auto subscription = observable.subscribe([&results](std::string_view record) {
+        results.emplace_back(record);
+    },
+    [&on_end_call_times]() {
+        ++on_end_call_times;
+    },
+    [&errors](const std::string& descr) {
+        errors.push_back(descr);
+    });
+    source.emit(observable);
+
+    EXPECT_EQ(std::vector<std::string>{ "abc" }, results);
+    EXPECT_EQ(1u, errors.size());
+    EXPECT_EQ(0, on_end_call_times);
+
+    tiny_rx::Observable<std::vector<std::string_view>> batches;
+    EXPECT_THROW(source.emit_batches(batches, 0), std::invalid_argument);
+}
+
+TEST(Observable_File_Sources, Mapped_File_Truncated_Length) {
+    // "abc", then 2 of the 4 bytes of the next length
+    const TempFile file(std::string("\x03\0\0\0abc\x05\0", 9));
+    tiny_rx::MappedFileSource source(file.path(), { tiny_rx::RecordFraming::LengthPrefixed });
+
+    tiny_rx::Observable<std::vector<std::string_view>> observable;
+    std::vector<std::string> results;
+    std::vector<std::string> errors;
+    int on_end_call_times = 0;
+    auto subscription = observable.subscribe([&results](const std::vector<std::string_view>& records) {
+        for (const auto& r : records) {
+            results.emplace_back(r);
+        }
+    },
+    [&on_end_call_times]() {
+        ++on_end_call_times;
+    },
+    [&errors](const std::string& descr) {
+        errors.push_back(descr);
+    });
+    source.emit_batches(observable, 4);
+
+    EXPECT_EQ(std::vector<std::string>{ "abc" }, results);
+    EXPECT_EQ(1u, errors.size());
+    EXPECT_EQ(0, on_end_call_times);
+}
+
+TEST(Observable_File_Sources, Mapped_File_Fixed_Size_Batches) {
+    const TempFile file("aaaabbbbccccdddde");
+    tiny_rx::MappedFileSourceParams params;
+    params.framing = tiny_rx::RecordFraming::FixedSize;
+    params.record_size = 4;
+    tiny_rx::MappedFileSource source(file.path(), params);
+
+    tiny_rx::Observable<std::vector<std::string_view>> observable;
+    std::vector<size_t> batch_sizes;
+    std::string joined;
+    auto subscription = observable.subscribe([&batch_sizes, &joined](const std::vector<std::string_view>& records) {
+        batch_sizes.push_back(records.size());
+        for (const auto& r : records) {
+            joined += r;
+        }
+    });
+    source.emit_batches(observable, 3);
+
+    EXPECT_EQ((std::vector<size_t>{ 3, 1 }), batch_sizes);
+    EXPECT_EQ("aaaabbbbccccdddd", joined);
+}
+
+TEST(Observable_File_Sources, Record_Replay) {
+    const TempFile file("");
+    const std::vector<int> int_values{ 1, 2, 3, 4 };
+    const std::vector<std::string> str_values{ "A", "", "CCC", "D" };
+
+    {
+        tiny_rx::Observable<int, std::string> observable;
+        auto recorder = std::make_shared<tiny_rx::StreamRecorder<int, std::string>>(file.path());
+        auto subscription = observable.subscribe(recorder);
+        for (size_t i = 0; i < int_values.size(); ++i) {
+            observable.next(int_values[i], str_values[i]);
+        }
+        observable.error("error");
+        observable.end();
+    }
+
+    tiny_rx::Observable<int, std::string> observable;
+    std::vector<int> int_results;
+    std::vector<std::string> str_results;
+    std::vector<std::string> errors;
+    int on_end_call_times = 0;
+    auto subscription = observable.subscribe([&int_results, &str_results](int v, const std::string& s) {
+        int_results.push_back(v);
+        str_results.push_back(s);
+    },
+    [&on_end_call_times]() {
+        ++on_end_call_times;
+    },
+    [&errors](const std::string& descr) {
+        errors.push_back(descr);
+    });
+
+    tiny_rx::StreamReplayer<int, std::string> replayer(file.path());
+    replayer.replay(observable, tiny_rx::ReplaySpeed::Original);
+
+    EXPECT_EQ(int_values, int_results);
+    EXPECT_EQ(str_values, str_results);
+    EXPECT_EQ((std::vector<std::string>{ "error" }), errors);
+    EXPECT_EQ(1, on_end_call_times);
+}
+
+TEST(Observable_File_Sources, Record_Replay_Truncated) {
+    const TempFile file("");
+    {
+        tiny_rx::Observable<Point> observable;
+        auto recorder = std::make_shared<tiny_rx::StreamRecorder<Point>>(file.path());
+        auto subscription = observable.subscribe(recorder);
+        observable.next(Point{ 1, 2 });
+        observable.next(Point{ 3, 4 });
+        observable.end();
+    }
+    // Cut the end record and a part of the second value
+    std::filesystem::resize_file(file.path(), std::filesystem::file_size(file.path()) - 13 - 4);
+
+    tiny_rx::Observable<Point> observable;
+    std::vector<int> results;
+    std::vector<std::string> errors;
+    int on_end_call_times = 0;
+    auto subscription = observable.subscribe([&results](const Point& p) {
+        results.push_back(p.x);
+        results.push_back(p.y);
+    },
+    [&on_end_call_times]() {
+        ++on_end_call_times;
+    },
+    [&errors](const std::string& descr) {
+        errors.push_back(descr);
+    });
+
+    tiny_rx::StreamReplayer<Point> replayer(file.path());
+    EXPECT_NO_THROW(replayer.replay(observable));
+
+    EXPECT_EQ((std::vector<int>{ 1, 2 }), results);
+    EXPECT_EQ(std::vector<std::string>{ "StreamReplayer: truncated record" }, errors);
+    EXPECT_EQ(0, on_end_call_times);
+}
+
+TEST(Observable_File_Sources, Record_Replay_Views) {
+    const TempFile records("first\nsecond\nlast");
+    const TempFile file("");
+
+    {
+        tiny_rx::MappedFileSource source(records.path());
+        tiny_rx::Observable<std::string_view> observable;
+        auto recorder = std::make_shared<tiny_rx::StreamRecorder<std::string_view>>(file.path());
+        auto subscription = observable.subscribe(recorder);
+        source.emit(observable);
+    }
+
+    tiny_rx::Observable<std::string_view> observable;
+    std::vector<std::string> results;
+    auto subscription = observable.subscribe([&results](std::string_view record) {
+        results.emplace_back(record);
+    });
+    tiny_rx::StreamReplayer<std::string_view> replayer(file.path());
+    replayer.replay(observable);
+
+    EXPECT_EQ((std::vector<std::string>{ "first", "second", "last" }), results);
+}
+
+TEST(Observable_File_Sources, File_Sink) {
+    const TempFile file("");
+    std::string etalon;
+
+    {
+        tiny_rx::FileSinkParams params;
+        params.writer.block_size = 64;
+        params.writer.max_queued_blocks = 2;
+        params.writer.sync_every_bytes = 256;
+        params.delimiter = "\n";
+        auto sink = std::make_shared<tiny_rx::FileSink>(file.path(), params);
+
+        tiny_rx::Observable<std::string> observable;
+        auto subscription = observable.subscribe(sink);
+        for (int i = 0; i < 100; ++i) {
+            const auto value = "value " + std::to_string(i);
+            observable.next(value);
+            etalon += value + "\n";
+        }
+        observable.end();
+
+        EXPECT_EQ(etalon.size(), sink->stats().bytes_written.load());
+        EXPECT_GE(sink->stats().syncs.load(), etalon.size() / 256);
+        EXPECT_LE(sink->stats().max_queue_depth.load(), 2u);
+    }
+
+    std::ifstream in(file.path(), std::ios::binary);
+    const std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(etalon, content);
+}
+
+TEST(Observable_File_Sources, File_Sink_Sync_Interval) {
+    const TempFile file("");
+    tiny_rx::FileSinkParams params;
+    params.writer.sync_interval = std::chrono::milliseconds(20);
+    tiny_rx::FileSink sink(file.path(), params);
+
+    sink.on_next("0123456789");
+
+    // Partially filled block is committed by the I/O thread without flush()
+    for (int i = 0; i < 100 && sink.stats().syncs == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(10u, sink.stats().bytes_written.load());
+    EXPECT_LE(1u, sink.stats().syncs.load());
+    // Queued through the same bounded path as full blocks
+    EXPECT_EQ(1u, sink.stats().max_queue_depth.load());
+}
@@ -3,7 +3,10 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <memory>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 TEST(Observable_Source_Int, Check_Next) {
     tiny_rx::Observable<int> observable;
@@ -210,3 +213,125 @@ TEST(Observable_Source_Int, Check_Unsubscribe) {
     EXPECT_EQ(on_end_call_times, 1);
     EXPECT_THAT(errors, testing::ElementsAreArray(collected_errors));
 }
+
+static_assert(std::is_move_constructible_v<tiny_rx::Observable<int>>);
+static_assert(std::is_move_assignable_v<tiny_rx::Observable<int>>);
+
+TEST(Observable_Source_Int, Check_Move) {
+    const auto live_before = tiny_rx::live_observables();
+    std::vector<int> results;
+    {
+        auto source = tiny_rx::Observable<int>();
+        auto moved = std::move(source);
+        EXPECT_EQ(live_before + 2, tiny_rx::live_observables());
+
+        auto subscription = moved
+            .filter([](int v) { return v % 2 == 0; })
+            .subscribe([&results](int v) {
+                results.push_back(v);
+            });
+        for (auto v : { 1, 2, 3, 4 }) {
+            moved.next(v);
+        }
+    }
+
+    EXPECT_EQ((std::vector<int>{ 2, 4 }), results);
+    EXPECT_EQ(live_before, tiny_rx::live_observables());
+}
+
+TEST(Observable_Source_Int, Check_Move_Subscribed) {
+    const auto live_before = tiny_rx::live_observables();
+    std::vector<int> results;
+    {
+        tiny_rx::Observable<int> source;
+        auto subscription = source.subscribe([&results](int v) {
+            results.push_back(v);
+        });
+
+        tiny_rx::Observable<int> moved;
+        moved = std::move(source);
+        moved.next(1);
+        // The subscription refers to the moved-from observable, it's invalidated
+        subscription.unsubscribe();
+        source.next(2);
+        moved.next(3);
+        EXPECT_EQ(1u, moved.subscribers_count());
+        EXPECT_EQ(0u, source.subscribers_count());
+
+        auto constructed = std::move(moved);
+        constructed.next(4);
+    }
+
+    EXPECT_EQ((std::vector<int>{ 1, 3, 4 }), results);
+    EXPECT_EQ(live_before, tiny_rx::live_observables());
+}
+
+TEST(Observable_Compact, Check_Size) {
+#ifdef _DEBUG
+    constexpr size_t debug_size = sizeof(tiny_rx::Guid);
+#else
+    constexpr size_t debug_size = 0;
+#endif
+    // Two inline subscribers, the overflow vector and a few counters
+    EXPECT_LE(sizeof(tiny_rx::CompactObservable<int>), 192u + debug_size);
+    EXPECT_LE(sizeof(tiny_rx::CompactObservable<int>) * 2, sizeof(tiny_rx::Observable<int>) + debug_size);
+}
+
+TEST(Observable_Compact, Check_Next_Unsubscribe) {
+    tiny_rx::CompactObservable<int, std::string> observable;
+
+    std::vector<std::string> results;
+    std::vector<tiny_rx::Subscription> subscriptions;
+    int end_calls = 0;
+    for (int i = 0; i < 4; ++i) {
+        subscriptions.push_back(observable.subscribe([&results, i](int v, const std::string& s) {
+            results.push_back(std::to_string(i) + ":" + std::to_string(v) + s);
+        },
+        [&end_calls]() {
+            ++end_calls;
+        }));
+    }
+    EXPECT_EQ(4u, observable.subscribers_count());
+
+    observable.next(1, "a");
+    subscriptions[0].unsubscribe();
+    subscriptions[2].unsubscribe();
+    EXPECT_EQ(2u, observable.subscribers_count());
+    observable.next(2, "b");
+    observable.end();
+
+    const std::vector<std::string> etalon{ "0:1a", "1:1a", "2:1a", "3:1a", "1:2b", "3:2b" };
+    EXPECT_EQ(etalon, results);
+    EXPECT_EQ(2, end_calls);
+}
+
+TEST(Observable_Compact, Check_Unsubscribe_From_On_Next) {
+    auto run_loop = std::make_shared<tiny_rx::RunLoopExecutor>();
+    std::vector<int> results;
+    std::vector<int> executor_results;
+
+    tiny_rx::Subscription subscription;
+    {
+        tiny_rx::CompactObservable<int> observable;
+        subscription = observable.subscribe([&results, &subscription](int v) {
+            results.push_back(v);
+            subscription.unsubscribe();
+        });
+        auto executor_subscription = observable
+            .subscribe_on(run_loop)
+            .subscribe([&executor_results](int v) {
+                executor_results.push_back(v);
+            });
+
+        observable.next(1);
+        observable.next(2);
+        EXPECT_EQ(1u, observable.subscribers_count());
+    }
+    run_loop->dispatch();
+    run_loop->dispatch();
+
+    EXPECT_EQ((std::vector<int>{ 1 }), results);
+    EXPECT_EQ((std::vector<int>{ 1, 2 }), executor_results);
+    // The observable no longer exists
+    subscription.unsubscribe();
+}
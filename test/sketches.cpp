@@ -0,0 +1,189 @@
+#include "tiny_rx.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+std::vector<double> latencies(size_t count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::lognormal_distribution<double> dist(3.0, 1.0);
+    std::vector<double> values(count);
+    for (auto& v : values) {
+        v = dist(rng);
+    }
+    return values;
+}
+
+double exact_quantile(std::vector<double> values, double q) {
+    std::sort(values.begin(), values.end());
+    return values[static_cast<size_t>(q * static_cast<double>(values.size() - 1))];
+}
+
+}
+
+TEST(Sketches, DDSketch_Relative_Accuracy) {
+    const auto values = latencies(100000, 1);
+    tiny_rx::DDSketch sketch(0.01);
+    for (const auto v : values) {
+        sketch.add(v);
+    }
+
+    EXPECT_EQ(values.size(), sketch.count());
+    for (const double q : { 0.0, 0.5, 0.9, 0.99, 0.999, 1.0 }) {
+        const auto exact = exact_quantile(values, q);
+        EXPECT_NEAR(exact, sketch.quantile(q), exact * 0.01) << "q = " << q;
+    }
+
+    tiny_rx::DDSketch negative(0.01);
+    for (const double v : { -5.0, -1.0, 0.0, 1.0, 5.0 }) {
+        negative.add(v);
+    }
+    EXPECT_DOUBLE_EQ(-5.0, negative.quantile(0));
+    EXPECT_DOUBLE_EQ(0.0, negative.quantile(0.5));
+    EXPECT_NEAR(1.0, negative.quantile(0.75), 0.01);
+}
+
+TEST(Sketches, DDSketch_Infinities) {
+    constexpr auto inf = std::numeric_limits<double>::infinity();
+    tiny_rx::DDSketch sketch(0.01);
+    sketch.add(inf);
+    sketch.add(1.0, 98);
+    sketch.add(inf);
+    EXPECT_EQ(100u, sketch.count());
+    EXPECT_EQ(inf, sketch.quantile(0.99));
+    EXPECT_EQ(inf, sketch.quantile(1));
+    EXPECT_NEAR(1.0, sketch.quantile(0.9), 0.01);
+
+    tiny_rx::DDSketch other(0.01);
+    other.add(-inf, 2);
+    other.add(std::nan(""));
+    sketch.merge(other);
+    EXPECT_EQ(102u, sketch.count());
+    EXPECT_EQ(-inf, sketch.quantile(0));
+    EXPECT_NEAR(1.0, sketch.quantile(0.5), 0.01);
+    EXPECT_EQ(inf, sketch.quantile(1));
+}
+
+TEST(Sketches, Merge_Partial_Sketches) {
+    const auto first = latencies(50000, 2);
+    const auto second = latencies(50000, 3);
+    tiny_rx::DDSketch lhs;
+    tiny_rx::DDSketch rhs;
+    for (const auto v : first) {
+        lhs.add(v);
+    }
+    for (const auto v : second) {
+        rhs.add(v);
+    }
+    lhs.merge(rhs);
+
+    auto all = first;
+    all.insert(all.end(), second.begin(), second.end());
+    const auto exact = exact_quantile(all, 0.99);
+    EXPECT_NEAR(exact, lhs.quantile(0.99), exact * 0.01);
+    EXPECT_THROW(lhs.merge(tiny_rx::DDSketch(0.05)), std::invalid_argument);
+
+    auto histogram = tiny_rx::FixedHistogram::linear(10, 10, 10);
+    auto other = histogram;
+    for (int v = 1; v <= 50; ++v) {
+        histogram.add(v);
+        other.add(v + 50);
+    }
+    histogram.merge(other);
+    EXPECT_EQ(100u, histogram.count());
+    EXPECT_EQ(11u, histogram.counts().size());
+    EXPECT_EQ(10u, histogram.counts()[0]);
+    EXPECT_EQ(10u, histogram.counts()[9]);
+    EXPECT_EQ(0u, histogram.counts()[10]);
+    EXPECT_NEAR(50.0, histogram.quantile(0.5), 1.0);
+    EXPECT_NEAR(99.0, histogram.quantile(0.99), 1.0);
+}
+
+TEST(Sketches, Sketch_On_Thread_Pool) {
+    tiny_rx::Observable<double> observable;
+    auto pool = std::make_shared<tiny_rx::ThreadPoolExecutor>(4);
+    auto sketch = std::make_shared<tiny_rx::ShardedSketch<tiny_rx::DDSketch>>(tiny_rx::DDSketch(0.01), 4);
+
+    std::atomic<size_t> snapshots{ 0 };
+    auto subscription = observable.subscribe_on(pool).sketch(sketch, 10000).subscribe([&snapshots](const tiny_rx::DDSketch&) {
+        ++snapshots;
+    });
+
+    const auto values = latencies(40000, 4);
+    for (const auto v : values) {
+        observable.next(v);
+    }
+    while (sketch->snapshot().count() != values.size()) {
+        std::this_thread::yield();
+    }
+
+    const auto merged = sketch->snapshot();
+    const auto exact = exact_quantile(values, 0.999);
+    EXPECT_NEAR(exact, merged.quantile(0.999), exact * 0.01);
+    while (snapshots != 4) {
+        std::this_thread::yield();
+    }
+}
+
+TEST(Sketches, HyperLogLog_Cardinality) {
+    tiny_rx::Observable<uint64_t> observable;
+
+    constexpr uint64_t unique = 200000;
+    uint64_t estimate = 0;
+    size_t estimates = 0;
+    auto subscription = observable.count_distinct(0.01, 100000).subscribe([&](uint64_t v) {
+        estimate = v;
+        ++estimates;
+    });
+    for (uint64_t i = 0; i < 2 * unique; ++i) {
+        observable.next(i % unique);
+    }
+    observable.end();
+
+    EXPECT_EQ(5u, estimates);
+    EXPECT_NEAR(static_cast<double>(unique), static_cast<double>(estimate), unique * 0.03);
+
+    auto lhs = tiny_rx::HyperLogLog::for_error_rate(0.01);
+    auto rhs = tiny_rx::HyperLogLog::for_error_rate(0.01);
+    EXPECT_EQ(16384u, lhs.memory_bytes());
+    for (uint64_t i = 0; i < 1000; ++i) {
+        lhs.add(tiny_rx::mix_hash(i));
+        rhs.add(tiny_rx::mix_hash(i + 500));
+    }
+    lhs.merge(rhs);
+    EXPECT_NEAR(1500.0, static_cast<double>(lhs.estimate()), 1500 * 0.03);
+}
+
+TEST(Sketches, Bloom_Filter_Error_Rate) {
+    constexpr size_t capacity = 10000;
+    tiny_rx::BloomFilter filter(capacity, 0.01);
+    size_t inserted = 0;
+    for (uint64_t i = 0; i < capacity; ++i) {
+        inserted += filter.insert(tiny_rx::mix_hash(i)) ? 1 : 0;
+    }
+    // New keys taken for seen ones
+    EXPECT_GT(inserted, capacity - capacity / 100);
+    for (uint64_t i = 0; i < capacity; ++i) {
+        EXPECT_TRUE(filter.contains(tiny_rx::mix_hash(i)));
+    }
+
+    size_t false_positives = 0;
+    for (uint64_t i = capacity; i < 2 * capacity; ++i) {
+        false_positives += filter.contains(tiny_rx::mix_hash(i)) ? 1 : 0;
+    }
+    EXPECT_LT(false_positives, capacity / 100);
+
+    // Memory doesn't grow: older keys are forgotten
+    const auto memory = filter.memory_bytes();
+    for (uint64_t i = capacity; i < 10 * capacity; ++i) {
+        filter.insert(tiny_rx::mix_hash(i));
+    }
+    EXPECT_EQ(memory, filter.memory_bytes());
+    EXPECT_FALSE(filter.contains(tiny_rx::mix_hash(0)));
+}
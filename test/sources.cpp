@@ -2,7 +2,16 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string>
 #include <thread>
+#include <tuple>
+#include <vector>
 
 TEST(Observable_Sources, Vector_Source) {
     tiny_rx::Observable<int> observable;
@@ -24,3 +33,147 @@ TEST(Observable_Sources, Vector_Source) {
 
     EXPECT_EQ(values, results);
 }
+
+TEST(Observable_Sources, Cold_Source_Demand) {
+    tiny_rx::Observable<int> observable;
+    tiny_rx::ColdSource<int> source(observable, tiny_rx::ColdSource<int>::range(0, 100));
+
+    std::vector<int> results;
+    tiny_rx::Subscription subscription;
+    subscription = observable
+        .with_demand()
+        .subscribe([&results, &subscription](int v) {
+            results.push_back(v);
+            // Request the next portion once the current one is processed
+            if (results.size() % 10 == 0)
+                subscription.request(10);
+        });
+
+    source.start();
+    EXPECT_TRUE(results.empty());
+
+    subscription.request(10);
+    EXPECT_EQ(100u, results.size());
+    EXPECT_TRUE(source.finished());
+}
+
+TEST(Observable_Sources, Cold_Source_Bounded_Queue) {
+    auto run_loop = std::make_shared<tiny_rx::RunLoopExecutor>();
+    tiny_rx::Observable<int> observable;
+    tiny_rx::ColdSource<int> source(observable, tiny_rx::ColdSource<int>::range(0, 1000));
+
+    std::vector<int> results;
+    tiny_rx::Subscription subscription;
+    subscription = observable
+        .subscribe_on(run_loop)
+        .with_demand()
+        .subscribe([&results, &subscription](int v) {
+            results.push_back(v);
+            subscription.request(1);
+        });
+
+    subscription.request(4);
+    source.start();
+
+    size_t max_queue_size = 0;
+    while (run_loop->size() != 0) {
+        max_queue_size = std::max(max_queue_size, run_loop->size());
+        run_loop->dispatch();
+    }
+
+    std::vector<int> etalon(1000);
+    std::iota(etalon.begin(), etalon.end(), 0);
+    EXPECT_EQ(etalon, results);
+    EXPECT_EQ(4u, max_queue_size);
+}
+
+TEST(Observable_Sources, Cold_Source_Demand_Through_Operators) {
+    tiny_rx::Observable<int> observable;
+    tiny_rx::ColdSource<int> source(observable, tiny_rx::ColdSource<int>::range(1, 100));
+
+    std::vector<int> results;
+    auto subscription = observable
+        .filter([](int v) { return v % 2 == 0; })
+        .map([](int v) { return v * 10; })
+        .with_demand()
+        .subscribe([&results](int v) {
+            results.push_back(v);
+        });
+
+    source.start();
+    EXPECT_TRUE(results.empty());
+
+    subscription.request(3);
+    EXPECT_EQ((std::vector<int>{ 20, 40, 60 }), results);
+    EXPECT_FALSE(source.finished());
+}
+
+TEST(Observable_Sources, Cold_Source_Requests_From_Executor_Threads) {
+    constexpr int values_count = 20000;
+    auto pool = std::make_shared<tiny_rx::ThreadPoolExecutor>(4);
+    tiny_rx::Observable<int> observable;
+    tiny_rx::ColdSource<int> source(observable, tiny_rx::ColdSource<int>::range(0, values_count));
+
+    // Counted after the request, so nothing touches the source once all are counted
+    std::atomic<int> processed = 0;
+    tiny_rx::Subscription subscription;
+    subscription = observable
+        .subscribe_on(pool)
+        .with_demand()
+        .subscribe([&processed, &subscription](int) {
+            subscription.request(1);
+            ++processed;
+        });
+
+    subscription.request(8);
+    source.start();
+
+    // A lost request would stall the stream
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (processed != values_count && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(values_count, processed.load());
+    EXPECT_TRUE(source.finished());
+}
+
+TEST(Observable_Sources, Cold_Source_Request_Without_With_Demand) {
+    tiny_rx::Observable<int> observable;
+    tiny_rx::ColdSource<int> source(observable, tiny_rx::ColdSource<int>::range(0, 100));
+
+    std::vector<int> results;
+    auto subscription = observable.subscribe([&results](int v) {
+        results.push_back(v);
+    });
+
+    // The first request switches the subscriber to the demand mode
+    subscription.request(3);
+    source.start();
+    EXPECT_EQ((std::vector<int>{ 0, 1, 2 }), results);
+    EXPECT_FALSE(source.finished());
+}
+
+TEST(Observable_Sources, Cold_Source_Generator_Error) {
+    tiny_rx::Observable<int> observable;
+    int generated = 0;
+    tiny_rx::ColdSource<int> source(observable, [&generated]() -> std::optional<std::tuple<int>> {
+        if (generated == 2)
+            throw std::runtime_error("generator failed");
+        return std::make_tuple(generated++);
+    });
+
+    std::vector<int> results;
+    std::vector<std::string> errors;
+    auto subscription = observable.subscribe([&results](int v) {
+        results.push_back(v);
+    },
+    []() {},
+    [&errors](const std::string& descr) {
+        errors.push_back(descr);
+    });
+
+    source.start();
+    EXPECT_EQ((std::vector<int>{ 0, 1 }), results);
+    EXPECT_EQ(std::vector<std::string>{ "generator failed" }, errors);
+    EXPECT_TRUE(source.finished());
+}
@@ -2,6 +2,11 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <numeric>
+
 namespace {
 auto upper = [](std::string s) {
     for (auto& c : s) {
@@ -146,3 +151,158 @@ TEST(Observable_Stream_Functions, Check_Reduce_Many_Values) {
 
     EXPECT_EQ(etalon, result);
 }
+
+TEST(Observable_Stream_Functions, Check_Group_By) {
+    tiny_rx::Observable<int> observable;
+
+    const std::vector<int> values{ 1, 2, 3, 4, 5, 6, 7, 8 };
+    const std::vector<int> odd_etalon{ 1, 3, 5, 7 };
+    const std::vector<int> even_etalon{ 2, 4, 6, 8 };
+    std::map<bool, std::vector<int>> results;
+    std::vector<tiny_rx::Subscription> group_subscriptions;
+    int groups_ended = 0;
+
+    auto subscription = observable.group_by([](int v) {
+        return v % 2 == 0;
+    }).subscribe([&results, &group_subscriptions, &groups_ended](bool is_even, std::shared_ptr<tiny_rx::Observable<int>> group) {
+        group_subscriptions.push_back(group->subscribe([&results, is_even](int v) {
+            results[is_even].push_back(v);
+        },
+        [&groups_ended]() {
+            ++groups_ended;
+        }));
+    });
+
+    for (const auto v : values) {
+        observable.next(v);
+    }
+    observable.end();
+
+    EXPECT_EQ(odd_etalon, results[false]);
+    EXPECT_EQ(even_etalon, results[true]);
+    EXPECT_EQ(2, groups_ended);
+}
+
+TEST(Observable_Stream_Functions, Check_Scan) {
+    tiny_rx::Observable<int> observable;
+
+    std::vector<int64_t> results;
+    auto subscription = observable.scan([](int64_t acc, int v) {
+        return acc + v;
+    }, int64_t{ 100 }).subscribe([&results](int64_t v) {
+        results.push_back(v);
+    });
+
+    for (int v = 1; v <= 4; ++v) {
+        observable.next(v);
+    }
+    EXPECT_EQ(std::vector<int64_t>({ 101, 103, 106, 110 }), results);
+}
+
+TEST(Observable_Stream_Functions, Sliding_Count_Window) {
+    tiny_rx::Observable<int> observable;
+
+    constexpr size_t window = 7;
+    std::vector<int> sums;
+    std::vector<int> mins;
+    std::vector<int> maxs;
+    std::vector<double> averages;
+    auto sum_subscription = observable.sliding<tiny_rx::window::Sum>(window).subscribe([&sums](int v) { sums.push_back(v); });
+    auto min_subscription = observable.sliding<tiny_rx::window::Min>(window).subscribe([&mins](int v) { mins.push_back(v); });
+    auto max_subscription = observable.sliding<tiny_rx::window::Max>(window).subscribe([&maxs](int v) { maxs.push_back(v); });
+    auto avg_subscription = observable.sliding<tiny_rx::window::Average>(window).subscribe([&averages](double v) {
+        averages.push_back(v);
+    });
+
+    std::vector<int> values;
+    uint32_t seed = 12345;
+    for (int i = 0; i < 200; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        values.push_back(static_cast<int>(seed >> 16) % 1000 - 500);
+        observable.next(values.back());
+    }
+
+    ASSERT_EQ(values.size(), sums.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        const auto first = values.begin() + static_cast<std::ptrdiff_t>(i + 1 > window ? i + 1 - window : 0);
+        const auto last = values.begin() + static_cast<std::ptrdiff_t>(i + 1);
+        const int sum = std::accumulate(first, last, 0);
+        EXPECT_EQ(sum, sums[i]);
+        EXPECT_EQ(*std::min_element(first, last), mins[i]);
+        EXPECT_EQ(*std::max_element(first, last), maxs[i]);
+        EXPECT_DOUBLE_EQ(static_cast<double>(sum) / static_cast<double>(last - first), averages[i]);
+    }
+}
+
+TEST(Observable_Stream_Functions, Sliding_Time_Window) {
+    tiny_rx::Observable<int> observable;
+
+    std::chrono::nanoseconds now{ 0 };
+    std::vector<int> maxs;
+    auto subscription = observable.sliding<tiny_rx::window::Max>(std::chrono::seconds(10), [&now]() {
+        return now;
+    }).subscribe([&maxs](int v) {
+        maxs.push_back(v);
+    });
+
+    observable.next(5);
+    now = std::chrono::seconds(5);
+    observable.next(3);
+    now = std::chrono::seconds(12);
+    observable.next(1);
+    now = std::chrono::seconds(30);
+    observable.next(2);
+    EXPECT_EQ(std::vector<int>({ 5, 5, 3, 2 }), maxs);
+}
+
+TEST(Observable_Stream_Functions, Check_Distinct) {
+    tiny_rx::Observable<int> observable;
+
+    std::vector<int> changed;
+    auto changed_subscription = observable.distinct_until_changed().subscribe([&changed](int v) {
+        changed.push_back(v);
+    });
+
+    std::vector<int> distinct;
+    tiny_rx::DistinctParams params;
+    params.max_keys = 3;
+    auto distinct_subscription = observable.distinct(params).subscribe([&distinct](int v) {
+        distinct.push_back(v);
+    });
+
+    std::vector<int> approx;
+    auto approx_subscription = observable.approx_distinct([](int v) { return v; }, 1000).subscribe([&approx](int v) {
+        approx.push_back(v);
+    });
+
+    for (const int v : { 1, 1, 2, 1, 3, 3, 4, 1, 5, 2 }) {
+        observable.next(v);
+    }
+    EXPECT_EQ(std::vector<int>({ 1, 2, 1, 3, 4, 1, 5, 2 }), changed);
+    // Only 3 keys are kept: 2 is forgotten after 3, 4, 1 and 5
+    EXPECT_EQ(std::vector<int>({ 1, 2, 3, 4, 5, 2 }), distinct);
+    EXPECT_EQ(std::vector<int>({ 1, 2, 3, 4, 5 }), approx);
+}
+
+TEST(Observable_Stream_Functions, Distinct_Ttl) {
+    tiny_rx::Observable<std::string> observable;
+
+    std::chrono::nanoseconds now{ 0 };
+    tiny_rx::DistinctParams params;
+    params.ttl = std::chrono::seconds(10);
+    params.now = [&now]() { return now; };
+
+    std::vector<std::string> results;
+    auto subscription = observable.distinct([](const std::string& s) { return s; }, params).subscribe([&results](const std::string& s) {
+        results.push_back(s);
+    });
+
+    observable.next("a");
+    observable.next("b");
+    now = std::chrono::seconds(5);
+    observable.next("a");
+    now = std::chrono::seconds(10);
+    observable.next("a");
+    observable.next("b");
+    EXPECT_EQ(std::vector<std::string>({ "a", "b", "a", "b" }), results);
+}
@@ -5,9 +5,16 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 #include <thread>
+#include <vector>
 
 TEST(TinyRxThreads, Single_Thread_Rvalue)
 {
@@ -248,3 +255,565 @@ TEST(TinyRxThreads, Single_Thread_Map_And_OnNext_Another_Subscription_In_Main) {
     EXPECT_EQ(id_one, id_two);
     EXPECT_NE(id_one, main_thread_id);
 }
+
+TEST(TinyRxThreads, Run_Loop_Coalesced_Fan_Out) {
+    auto run_loop = std::make_shared<tiny_rx::RunLoopExecutor>();
+    auto other_run_loop = std::make_shared<tiny_rx::RunLoopExecutor>();
+    constexpr int subscribers_count = 50;
+    std::vector<std::pair<int, int>> results;
+    std::vector<int> other_results;
+
+    auto source = tiny_rx::Observable<int>();
+    std::vector<tiny_rx::Subscription> subscriptions;
+    for (int i = 0; i < subscribers_count; ++i) {
+        subscriptions.push_back(source
+            .subscribe_on(run_loop)
+            .subscribe([&results, i](int value) {
+                results.emplace_back(value, i);
+            }));
+    }
+    subscriptions.push_back(source
+        .subscribe_on(other_run_loop)
+        .subscribe([&other_results](int value) {
+            other_results.push_back(value);
+        }));
+
+    source.next(1);
+    source.next(2);
+
+    // One task per executor per value
+    EXPECT_EQ(2u, run_loop->size());
+    EXPECT_EQ(2u, other_run_loop->size());
+
+    // Unsubscribed subscriber still gets values emitted before
+    subscriptions.front().unsubscribe();
+    source.next(3);
+    EXPECT_EQ(3u, run_loop->size());
+
+    while (run_loop->size() != 0) {
+        run_loop->dispatch();
+    }
+    while (other_run_loop->size() != 0) {
+        other_run_loop->dispatch();
+    }
+
+    std::vector<std::pair<int, int>> etalon;
+    for (int value = 1; value <= 3; ++value) {
+        for (int i = value == 3 ? 1 : 0; i < subscribers_count; ++i)
+            etalon.emplace_back(value, i);
+    }
+    EXPECT_EQ(etalon, results);
+    EXPECT_EQ((std::vector<int>{ 1, 2, 3 }), other_results);
+}
+
+TEST(TinyRxThreads, Run_Loop_Conflating_Subscriber_Goes_First) {
+    auto run_loop = std::make_shared<tiny_rx::RunLoopExecutor>();
+    std::vector<std::string> calls;
+
+    auto source = tiny_rx::Observable<int>();
+    auto first = source
+        .subscribe_on(run_loop)
+        .subscribe([&calls](int value) {
+            calls.push_back("first " + std::to_string(value));
+        });
+    auto conflating = source
+        .subscribe_on(run_loop)
+        .conflate()
+        .subscribe([&calls](int value) {
+            calls.push_back("conflating " + std::to_string(value));
+        });
+    auto last = source
+        .subscribe_on(run_loop)
+        .subscribe([&calls](int value) {
+            calls.push_back("last " + std::to_string(value));
+        });
+
+    source.next(1);
+    // The conflating subscriber's task, then the shared task of the others
+    EXPECT_EQ(2u, run_loop->size());
+    while (run_loop->size() != 0) {
+        run_loop->dispatch();
+    }
+
+    const auto etalon = std::vector<std::string>{ "conflating 1", "first 1", "last 1" };
+    EXPECT_EQ(etalon, calls);
+}
+
+TEST(TinyRxThreads, Thread_Pool_Subscribers_Run_In_Parallel) {
+    auto pool = std::make_shared<tiny_rx::ThreadPoolExecutor>(2);
+    std::atomic<int> started = 0;
+    std::atomic<int> met = 0;
+    std::atomic<int> finished = 0;
+
+    // Each subscriber waits for the other one: fails if they run one after another
+    auto wait_for_other = [&started, &met, &finished](int) {
+        ++started;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (started != 2 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (started == 2)
+            ++met;
+        ++finished;
+    };
+
+    auto source = tiny_rx::Observable<int>();
+    auto first = source.subscribe_on(pool).subscribe(wait_for_other);
+    auto second = source.subscribe_on(pool).subscribe(wait_for_other);
+    source.next(1);
+
+    while (finished != 2) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(2, met.load());
+}
+
+TEST(TinyRxThreads, Run_Loop_Conflate) {
+    auto run_loop = std::make_shared<tiny_rx::RunLoopExecutor>();
+    std::vector<int> results;
+    std::vector<int> all_results;
+
+    auto source = tiny_rx::Observable<int>();
+    auto subscription = source
+        .subscribe_on(run_loop)
+        .conflate()
+        .subscribe([&results](int value) {
+            results.push_back(value);
+        });
+    auto all_subscription = source
+        .subscribe([&all_results](int value) {
+            all_results.push_back(value);
+        });
+
+    for (int frame = 0; frame < 3; ++frame) {
+        for (int v = 0; v < 10000; ++v) {
+            source.next(frame * 10000 + v);
+        }
+        EXPECT_EQ(1u, run_loop->size());
+        run_loop->dispatch();
+    }
+
+    EXPECT_EQ((std::vector<int>{ 9999, 19999, 29999 }), results);
+    EXPECT_EQ(30000u, all_results.size());
+}
+
+TEST(TinyRxThreads, Run_Loop_Conflate_By_Key) {
+    auto run_loop = std::make_shared<tiny_rx::RunLoopExecutor>();
+    std::vector<std::pair<std::string, int>> results;
+
+    auto source = tiny_rx::Observable<std::string, int>();
+    auto subscription = source
+        .subscribe_on(run_loop)
+        .conflate([](const std::string& name, int) { return name; })
+        .subscribe([&results](std::string name, int value) {
+            results.emplace_back(std::move(name), value);
+        });
+
+    for (int v = 0; v < 1000; ++v) {
+        source.next(v % 2 == 0 ? "cpu" : "memory", v);
+        if (v % 100 == 0)
+            source.next("disk", v);
+    }
+    EXPECT_EQ(1u, run_loop->size());
+    run_loop->dispatch();
+
+    const auto etalon = std::vector<std::pair<std::string, int>>{
+        { "cpu", 998 },
+        { "disk", 900 },
+        { "memory", 999 }
+    };
+    EXPECT_EQ(etalon, results);
+}
+
+namespace {
+
+// All keys have the same hash
+struct CollidingKey {
+    int id;
+    bool operator==(const CollidingKey& other) const { return id == other.id; }
+};
+
+}
+
+namespace std {
+template<>
+struct hash<CollidingKey> {
+    size_t operator()(const CollidingKey&) const { return 42; }
+};
+}
+
+TEST(TinyRxThreads, Run_Loop_Conflate_Colliding_Keys) {
+    auto run_loop = std::make_shared<tiny_rx::RunLoopExecutor>();
+    std::vector<std::pair<int, int>> results;
+
+    auto source = tiny_rx::Observable<int, int>();
+    auto subscription = source
+        .subscribe_on(run_loop)
+        .conflate([](int id, int) { return CollidingKey{ id }; })
+        .subscribe([&results](int id, int value) {
+            results.emplace_back(id, value);
+        });
+
+    for (int v = 0; v < 9; ++v) {
+        source.next(v % 3, v);
+    }
+    EXPECT_EQ(1u, run_loop->size());
+    run_loop->dispatch();
+
+    const auto etalon = std::vector<std::pair<int, int>>{ { 0, 6 }, { 1, 7 }, { 2, 8 } };
+    EXPECT_EQ(etalon, results);
+}
+
+TEST(TinyRxThreads, Keyed_Executor_Per_Key_Order) {
+    constexpr int keys_count = 10;
+    constexpr int values_per_key = 200;
+
+    auto keyed_executor = std::make_shared<tiny_rx::KeyedExecutor>(std::make_shared<tiny_rx::ThreadPoolExecutor>(4), 8);
+    std::mutex results_mutex;
+    std::map<int, std::vector<int>> results;
+    std::atomic<int> latch = 0;
+
+    auto source = tiny_rx::Observable<int, int>();
+    auto subscription = source
+        .subscribe_on(keyed_executor, [](int key, int) { return key; })
+        .subscribe([&results_mutex, &results](int key, int value) {
+            std::lock_guard lock(results_mutex);
+            results[key].push_back(value);
+        },
+        [&latch]() {
+            ++latch;
+        });
+
+    for (int v = 0; v < values_per_key; ++v) {
+        for (int key = 0; key < keys_count; ++key) {
+            source.next(key, v);
+        }
+    }
+    source.end();
+
+    // Wait for threads
+    while (latch != 1) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    std::vector<int> etalon(values_per_key);
+    std::iota(etalon.begin(), etalon.end(), 0);
+    ASSERT_EQ(static_cast<size_t>(keys_count), results.size());
+    for (const auto& [key, values] : results) {
+        EXPECT_EQ(etalon, values);
+    }
+}
+
+TEST(TinyRxThreads, Parallel_Map_Keeps_Order) {
+    constexpr int values_count = 64;
+    auto pool = std::make_shared<tiny_rx::ThreadPoolExecutor>(4);
+    auto stats = std::make_shared<tiny_rx::ReorderStats>();
+    std::vector<int> results;
+    std::atomic<int> latch = 0;
+
+    auto source = tiny_rx::Observable<int>();
+    auto subscription = source
+        .parallel_map([](int value) {
+            // Earlier values take longer to make results complete out of order
+            std::this_thread::sleep_for(std::chrono::microseconds((values_count - value % 8) * 50));
+            return value * 2;
+        }, pool, 8, stats)
+        .subscribe([&results](int value) {
+            results.push_back(value);
+        },
+        [&latch]() {
+            ++latch;
+        });
+
+    std::vector<int> etalon;
+    for (int v = 0; v < values_count; ++v) {
+        source.next(v);
+        etalon.push_back(v * 2);
+    }
+    source.end();
+
+    // Wait for threads
+    while (latch != 1) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    EXPECT_EQ(etalon, results);
+    EXPECT_EQ(static_cast<uint64_t>(values_count), stats->emitted.load());
+    EXPECT_LE(stats->max_buffered.load(), 8u);
+}
+
+TEST(TinyRxThreads, Parallel_Map_Drops_Results_After_Error) {
+    auto pool = std::make_shared<tiny_rx::ThreadPoolExecutor>(4);
+    auto stats = std::make_shared<tiny_rx::ReorderStats>();
+    std::vector<int> results;
+    std::vector<std::string> errors;
+    std::atomic<int> latch = 0;
+
+    auto source = tiny_rx::Observable<int>();
+    auto subscription = source
+        .parallel_map([](int value) {
+            if (value == 3)
+                throw std::runtime_error("bad value");
+            return value;
+        }, pool, 4, stats)
+        .subscribe([&results](int value) {
+            results.push_back(value);
+        },
+        [&latch]() {
+            ++latch;
+        },
+        [&errors, &latch](const std::string& descr) {
+            errors.push_back(descr);
+            ++latch;
+        });
+
+    for (int v = 0; v < 8; ++v) {
+        source.next(v);
+    }
+    source.end();
+
+    while (latch == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    // Let the results after the error and the end marker be dropped
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    EXPECT_EQ((std::vector<int>{ 0, 1, 2 }), results);
+    EXPECT_EQ(std::vector<std::string>{ "bad value" }, errors);
+    EXPECT_EQ(1, latch.load());
+    EXPECT_EQ(3u, stats->emitted.load());
+}
+
+TEST(TinyRxThreads, Parallel_Map_Non_Standard_Exception) {
+    auto pool = std::make_shared<tiny_rx::ThreadPoolExecutor>(2);
+    std::vector<int> results;
+    std::vector<std::string> errors;
+    std::atomic<int> latch = 0;
+
+    auto source = tiny_rx::Observable<int>();
+    auto subscription = source
+        .parallel_map([](int value) {
+            if (value == 1)
+                throw 42;
+            return value;
+        }, pool, 1)
+        .subscribe([&results](int value) {
+            results.push_back(value);
+        },
+        [&latch]() {
+            ++latch;
+        },
+        [&errors, &latch](const std::string& descr) {
+            errors.push_back(descr);
+            ++latch;
+        });
+
+    // With a single slot the producer would wait forever for an uncompleted one
+    for (int v = 0; v < 4; ++v) {
+        source.next(v);
+    }
+    source.end();
+
+    while (latch == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    EXPECT_EQ(std::vector<int>{ 0 }, results);
+    EXPECT_EQ(std::vector<std::string>{ "parallel_map: unknown exception" }, errors);
+    EXPECT_EQ(1, latch.load());
+}
+
+TEST(TinyRxThreads, Broadcast_Fan_Out) {
+    constexpr int values_count = 10000;
+    constexpr size_t consumers_count = 3;
+
+    tiny_rx::BroadcastParams params;
+    params.capacity = 64;
+    tiny_rx::BroadcastObservable<int, std::string> source(params);
+
+    std::vector<std::vector<int>> results(consumers_count);
+    std::vector<std::thread::id> thread_ids(consumers_count);
+    std::atomic<size_t> latch = 0;
+    std::vector<tiny_rx::Subscription> subscriptions;
+    for (size_t i = 0; i < consumers_count; ++i) {
+        subscriptions.push_back(source.subscribe(
+            [&results, &thread_ids, i](int value, const std::string& str) {
+                EXPECT_EQ(std::to_string(value), str);
+                thread_ids[i] = std::this_thread::get_id();
+                results[i].push_back(value);
+                // Slow consumer makes the producer wait
+                if (i == 0 && value % 1000 == 0)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            },
+            [&latch]() {
+                ++latch;
+            }));
+    }
+    EXPECT_EQ(consumers_count, source.subscribers_count());
+
+    std::vector<int> etalon(values_count);
+    std::iota(etalon.begin(), etalon.end(), 0);
+    for (auto v : etalon)
+        source.next(v, std::to_string(v));
+    source.end();
+
+    // Wait for threads
+    while (latch != consumers_count) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    for (size_t i = 0; i < consumers_count; ++i) {
+        EXPECT_EQ(etalon, results[i]);
+        EXPECT_NE(std::this_thread::get_id(), thread_ids[i]);
+    }
+    EXPECT_EQ(static_cast<uint64_t>(values_count + 1), source.published());
+    EXPECT_GT(source.producer_waits(), 0u);
+}
+
+TEST(TinyRxThreads, Broadcast_Unsubscribe) {
+    tiny_rx::BroadcastParams params;
+    params.capacity = 8;
+    params.max_consumers = 1;
+    tiny_rx::BroadcastObservable<int> source(params);
+
+    std::atomic<int> last = -1;
+    auto subscription = source.subscribe([&last](int value) {
+        last = value;
+    });
+    EXPECT_THROW(source.subscribe([](int) {}), std::runtime_error);
+
+    source.next(0);
+    while (last != 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    subscription.unsubscribe();
+    EXPECT_EQ(0u, source.subscribers_count());
+
+    // Nobody gates the producer: the ring is overwritten freely
+    for (int v = 1; v < 100; ++v)
+        source.next(v);
+    EXPECT_EQ(0, last);
+
+    // The slot is free again, new subscribers receive new values only
+    std::atomic<int> received = -1;
+    auto new_subscription = source.subscribe([&received](int value) {
+        received = value;
+    });
+    source.next(100);
+    while (received != 100) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+TEST(TinyRxThreads, Broadcast_Subscription_Outlives_Observable) {
+    tiny_rx::Subscription subscription;
+    {
+        tiny_rx::BroadcastObservable<int> source;
+        subscription = source.subscribe([](int) {});
+        EXPECT_EQ(1u, source.subscribers_count());
+    }
+    // The observable is gone, unsubscribing does nothing
+    subscription.unsubscribe();
+}
+
+TEST(TinyRxThreads, Virtual_Time_Order) {
+    tiny_rx::VirtualTimeExecutor executor;
+    using namespace std::chrono_literals;
+
+    std::vector<std::string> results;
+    executor.add_task_after(2s, [&results]() { results.emplace_back("2s"); });
+    executor.add_task_after(1s, [&results, &executor]() {
+        results.emplace_back("1s");
+        executor.add_task_after(500ms, [&results]() { results.emplace_back("1.5s"); });
+        executor.add_task_after(5s, [&results]() { results.emplace_back("6s"); });
+    });
+    executor.add_task([&results]() { results.emplace_back("now 1"); });
+    executor.add_task([&results]() { results.emplace_back("now 2"); });
+
+    EXPECT_EQ(2u, executor.run_pending());
+    EXPECT_EQ(3u, executor.advance_by(3s));
+    EXPECT_EQ(tiny_rx::VirtualTimeExecutor::TimePoint(3s), executor.now());
+    EXPECT_EQ(tiny_rx::VirtualTimeExecutor::TimePoint(6s), executor.next_due());
+
+    const std::vector<std::string> etalon{ "now 1", "now 2", "1s", "1.5s", "2s" };
+    EXPECT_EQ(etalon, results);
+}
+
+TEST(TinyRxThreads, Virtual_Time_Periodic_Source) {
+    auto executor = std::make_shared<tiny_rx::VirtualTimeExecutor>();
+    using namespace std::chrono_literals;
+
+    auto source = tiny_rx::Observable<int64_t>();
+    int64_t ticks = 0;
+    auto subscription = source
+        .subscribe_on(executor)
+        .subscribe([&ticks, executor](int64_t value) {
+            EXPECT_EQ(value, executor->now().time_since_epoch() / 100ms);
+            ++ticks;
+        });
+
+    // Emits every 100 ms of virtual time
+    std::function<void()> tick = [&]() {
+        source.next(executor->now().time_since_epoch() / 100ms);
+        executor->add_task_after(100ms, tick);
+    };
+    executor->add_task(tick);
+
+    const auto started = std::chrono::steady_clock::now();
+    executor->advance_by(1h);
+    EXPECT_LT(std::chrono::steady_clock::now() - started, 10s);
+
+    EXPECT_EQ(3600 * 10 + 1, ticks);
+}
+
+TEST(TinyRxThreads, Trace_Chrome_Json) {
+    tiny_rx::trace::clear();
+    tiny_rx::trace::enable();
+    // Buffers of live threads, including this one (the emissions record on it)
+    tiny_rx::trace::record(tiny_rx::trace::Phase::Instant, "start");
+    const auto buffers_before = tiny_rx::trace::buffers_count();
+
+    std::atomic<int> latch = 0;
+    {
+        auto map_executor = std::make_shared<tiny_rx::SingleThreadExecutor>();
+        auto filter_executor = std::make_shared<tiny_rx::ThreadPoolExecutor>(2);
+        auto result_executor = std::make_shared<tiny_rx::SingleThreadExecutor>();
+
+        auto source = tiny_rx::Observable<int>();
+        auto subscription = source
+            .subscribe_on(map_executor)
+            .map([](int value) { return value * 2; })
+            .subscribe_on(filter_executor)
+            .filter([](int value) { return value % 4 == 0; })
+            .subscribe_on(result_executor)
+            .named("result")
+            .subscribe([&latch](int) {
+                ++latch;
+            });
+
+        for (int v = 0; v < 10; ++v) {
+            source.next(v);
+        }
+
+        // Wait for threads
+        while (latch != 5) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    tiny_rx::trace::enable(false);
+
+    std::ostringstream out;
+    tiny_rx::trace::write_chrome_json(out);
+    const auto json = out.str();
+    for (const auto* expected : { "\"name\":\"emit\"", "\"name\":\"map\"", "\"name\":\"filter\"", "\"name\":\"result\"",
+                                  "\"ph\":\"s\"", "\"ph\":\"f\"", "\"ph\":\"B\"", "\"ph\":\"E\"" }) {
+        EXPECT_NE(std::string::npos, json.find(expected)) << expected;
+    }
+    EXPECT_EQ(0u, tiny_rx::trace::dropped());
+
+    // Map, result and at least one pool thread recorded. Their buffers are released,
+    // the threads have exited
+    EXPECT_LE(buffers_before + 3, tiny_rx::trace::buffers_count());
+    tiny_rx::trace::clear();
+    EXPECT_GE(buffers_before, tiny_rx::trace::buffers_count());
+}